@@ -10,6 +10,7 @@
 #include <boost/uuid/uuid_io.hpp>
 #include <boost/uuid/string_generator.hpp>
 
+#include "columnar_back.h"
 #include "cyclus.h"
 #include "hdf5_back.h"
 #include "pyhooks.h"
@@ -129,12 +130,31 @@ int main(int argc, char* argv[]) {
   std::string ext = fs::path(ai.output_path).extension().string();
   std::string stem = fs::path(ai.output_path).stem().string();
   if (ext == ".h5") {
-    fback = new Hdf5Back(ai.output_path.c_str());
+    Hdf5Back* h5back = new Hdf5Back(ai.output_path.c_str());
+    if (ai.vm.count("hdf5-compression") > 0) {
+      try {
+        h5back->set_compression(ai.vm["hdf5-compression"].as<std::string>());
+      } catch (cyclus::ValueError err) {
+        delete h5back;
+        std::cerr << err.what() << "\n";
+        return 1;
+      }
+    }
+    fback = h5back;
+  } else if (ext == ".cyccol") {
+    fback = new ColumnarBack(ai.output_path);
   } else {
-    fback = new SqliteBack(ai.output_path);
+    SqliteBack* sqlback = new SqliteBack(ai.output_path);
+    if (ai.vm.count("sqlite-bulk") > 0) {
+      sqlback->set_bulk(true);
+    }
+    fback = sqlback;
   }
   rec.RegisterBackend(fback);
   bdel.Add(fback);
+  if (ai.vm.count("async-output") > 0) {
+    rec.set_async(true);
+  }
 
   // Try to detect schema type
   std::stringstream input;
@@ -199,6 +219,8 @@ int main(int argc, char* argv[]) {
     std::string ext = dbfile.extension().string();
     if (ext == ".h5") {
       rback = new Hdf5Back(dbfile.c_str());
+    } else if (ext == ".cyccol") {
+      rback = new ColumnarBack(dbfile.string());
     } else {
       rback = new SqliteBack(dbfile.c_str());
     }
@@ -206,6 +228,9 @@ int main(int argc, char* argv[]) {
 
     si.Restart(rback, simid, t);
     si.recorder()->RegisterBackend(fback);
+    if (ai.vm.count("async-output") > 0) {
+      si.recorder()->set_async(true);
+    }
   }
 
   char* CYCLUS_NO_CATCH = getenv("CYCLUS_NO_CATCH");
@@ -221,6 +246,12 @@ int main(int argc, char* argv[]) {
   }
 
   rec.Flush();
+  if (ai.restart != "") {
+    // restarted simulations record through their own recorder
+    si.recorder()->Flush();
+  }
+  // builds the sqlite indexes now that all output is written
+  fback->Close();
 
   PyStop();
 
@@ -259,6 +290,12 @@ int ParseCliArgs(ArgInfo* ai, int argc, char* argv[]) {
       ("verb,v", po::value<std::string>(),
        "log verbosity. integer from 0 (quiet) to 11 (verbose).")
       ("output-path,o", po::value<std::string>(), "output path")
+      ("async-output", "write output to the database on a dedicated thread")
+      ("sqlite-bulk", "write sqlite output in bulk load mode - faster, but "
+                      "not crash safe and not portable across platforms")
+      ("hdf5-compression", po::value<std::string>(),
+       "hdf5 output compression: none or a comma separated list of shuffle, "
+       "deflate[:level] and lz4")
       ("input-file,i", po::value<std::string>(),
        "input file, may be a path or a raw string")
       ("format,f", po::value<std::string>()->default_value("none"),
@@ -138,6 +138,25 @@ cdef extern from "cyclus.h" namespace "cyclus":
         vector[DbTypes] types
         vector[QueryRow] rows
 
+    cdef cppclass QueryColumn:
+        QueryColumn() except +
+
+        std_string field
+        DbTypes type
+        vector[int] ints
+        vector[double] doubles
+        vector[int] codes
+        vector[std_string] strs
+        vector[uuid] uuids
+        vector[hold_any] vals
+
+    cdef cppclass ColumnarResult:
+        ColumnarResult() except +
+        ColumnarResult(const QueryResult&) except +
+
+        vector[QueryColumn] columns
+        int nrows
+
     cdef cppclass ColumnInfo:
         ColumnInfo()
         ColumnInfo(std_string, std_string, int, DbTypes, vector[int])
@@ -147,8 +166,18 @@ cdef extern from "cyclus.h" namespace "cyclus":
         DbTypes dbtype
         vector[int] shape
 
+    cdef cppclass QueryCursor:
+        cpp_bool Fetch(int, QueryResult*) except +
+
     cdef cppclass QueryableBackend:
         QueryResult Query(std_string, vector[Cond]*) except +
+        ColumnarResult QueryColumns(std_string, vector[Cond]*) except +
+        shared_ptr[QueryCursor] Cursor(std_string, vector[Cond]*) except +
+        QueryResult Query(std_string, vector[Cond]*, vector[std_string]*) except +
+        ColumnarResult QueryColumns(std_string, vector[Cond]*,
+                                    vector[std_string]*) except +
+        shared_ptr[QueryCursor] Cursor(std_string, vector[Cond]*,
+                                       vector[std_string]*) except +
         map[std_string, DbTypes] ColumnTypes(std_string) except +
         list[ColumnInfo] Schema(std_string)
         set[std_string] Tables() except +
@@ -183,6 +212,15 @@ cdef extern from "hdf5_back.h" namespace "cyclus":
         Hdf5Back(std_string) except +
 
 
+cdef extern from "columnar_back.h" namespace "cyclus":
+
+    cdef cppclass ColumnarBack(FullBackend):
+        ColumnarBack(std_string) except +
+        void Flush() except +
+        void Close() except +
+        std_string Name() except +
+
+
 cdef extern from "dynamic_module.h" namespace "cyclus":
 
     cdef cppclass AgentSpec:
@@ -536,6 +574,7 @@ cdef extern from "capacity_constraint.h" namespace "cyclus":
         double convert(shared_ptr[T], const Arc*)
         double convert(shared_ptr[T], const Arc*,
                        const ExchangeTranslationContext[T]*)
+        bool pure()
 
     cdef cppclass TrvialConverter[T](Converter[T]):
         pass
@@ -28,6 +28,8 @@ cdef class _Datum:
     cdef list _fieldnames
 
 cdef object query_result_to_py(cpp_cyclus.QueryResult)
+cdef object columnar_result_to_py(cpp_cyclus.ColumnarResult& cr,
+                                  bint categorical=*)
 cdef object single_query_result_to_py(cpp_cyclus.QueryResult qr, int row)
 
 cdef class _FullBackend:
@@ -39,6 +41,9 @@ cdef class _SqliteBack(_FullBackend):
 cdef class _Hdf5Back(_FullBackend):
     pass
 
+cdef class _ColumnarBack(_FullBackend):
+    pass
+
 cdef class _Recorder:
     cdef void * ptx
 
@@ -168,6 +168,62 @@ cdef object query_result_to_py(cpp_cyclus.QueryResult qr):
     return rtn
 
 
+cdef object columnar_result_to_py(cpp_cyclus.ColumnarResult& cr,
+                                  bint categorical=False):
+    """Converts a columnar query result object to a dictionary mapping fields
+    to column values and a list of field names in order. Numeric columns are
+    copied into NumPy arrays as a whole and dictionary encoded string and uuid
+    columns are expanded from their codes (or kept as pandas Categoricals if
+    categorical is True), so that only the values of other types are converted
+    one by one.
+    """
+    cdef int i, j
+    cdef int nrows = cr.nrows
+    cdef int ncols = cr.columns.size()
+    cdef cpp_typesystem.DbTypes t
+    cdef np.ndarray arr
+    cdef dict res = {}
+    cdef list fields = []
+    for j in range(ncols):
+        f = cr.columns[j].field.decode()
+        fields.append(f)
+        t = cr.columns[j].type
+        if t == cpp_typesystem.INT or t == cpp_typesystem.BOOL:
+            arr = np.empty(nrows, dtype=np.intc)
+            if nrows > 0:
+                memcpy(np.PyArray_DATA(arr), &cr.columns[j].ints[0],
+                       nrows * sizeof(int))
+            res[f] = arr.astype(bool if t == cpp_typesystem.BOOL else np.int64)
+        elif t == cpp_typesystem.DOUBLE or t == cpp_typesystem.FLOAT:
+            arr = np.empty(nrows, dtype=np.float64)
+            if nrows > 0:
+                memcpy(np.PyArray_DATA(arr), &cr.columns[j].doubles[0],
+                       nrows * sizeof(double))
+            res[f] = arr
+        elif t == cpp_typesystem.STRING or t == cpp_typesystem.VL_STRING or \
+             t == cpp_typesystem.UUID:
+            arr = np.empty(nrows, dtype=np.intc)
+            if nrows > 0:
+                memcpy(np.PyArray_DATA(arr), &cr.columns[j].codes[0],
+                       nrows * sizeof(int))
+            if t == cpp_typesystem.UUID:
+                cats = [uuid_cpp_to_py(cr.columns[j].uuids[i])
+                        for i in range(cr.columns[j].uuids.size())]
+            else:
+                cats = [cr.columns[j].strs[i].decode()
+                        for i in range(cr.columns[j].strs.size())]
+            if categorical:
+                res[f] = pd.Categorical.from_codes(arr, cats)
+            else:
+                vals = np.empty(len(cats), dtype=object)
+                vals[:] = cats
+                res[f] = vals[arr]
+        else:
+            res[f] = [db_to_py(cr.columns[j].vals[i], t) for i in range(nrows)]
+    rtn = (res, fields)
+    return rtn
+
+
 cdef object single_query_result_to_py(cpp_cyclus.QueryResult qr, int row):
     """Converts a query result object with only one row to a dictionary mapping
     fields to values and a list of field names in order.
@@ -188,6 +244,61 @@ cdef object single_query_result_to_py(cpp_cyclus.QueryResult qr, int row):
     return rtn
 
 
+cdef bint conds_py_to_cpp(cpp_cyclus.FullBackend* b, std_string tab, conds,
+                          std_vector[cpp_cyclus.Cond]* cpp_conds) except *:
+    """Converts a list of (field, op, value) conditions on table tab to C++
+    conditions, skipping non-existent columns. Returns False if there are no
+    conditions left.
+    """
+    cdef std_string field
+    cdef std_map[std_string, cpp_cyclus.DbTypes] coltypes
+    if conds is None:
+        return False
+    coltypes = b.ColumnTypes(tab)
+    for cond in conds:
+        cond0 = cond[0].encode()
+        cond1 = cond[1].encode()
+        field = std_string(<const char*> cond0)
+        if coltypes.count(field) == 0:
+            continue  # skips non-existent columns
+        cpp_conds.push_back(cpp_cyclus.Cond(field, cond1,
+            py_to_any(cond[2], coltypes[field])))
+    return cpp_conds.size() > 0
+
+
+cdef bint cols_py_to_cpp(columns, std_vector[std_string]* cpp_cols) except *:
+    """Converts a list of column names to C++. Returns False if columns is
+    None, i.e. all columns are wanted.
+    """
+    if columns is None:
+        return False
+    for col in columns:
+        cpp_cols.push_back(str_py_to_cpp(col))
+    return True
+
+
+cdef class _QueryCursor:
+    """Iterates over the rows of a query in batches, see _FullBackend.cursor().
+    The backend is kept alive for as long as the cursor is.
+    """
+    cdef cpp_cyclus.shared_ptr[cpp_cyclus.QueryCursor] ptx
+    cdef object backend
+    cdef int batch_size
+    cdef bint categorical
+
+    def __iter__(self):
+        return self
+
+    def __next__(self):
+        cdef cpp_cyclus.QueryResult qr
+        cdef cpp_cyclus.ColumnarResult cr
+        if not self.ptx.get().Fetch(self.batch_size, &qr):
+            raise StopIteration
+        cr = cpp_cyclus.ColumnarResult(qr)
+        res, fields = columnar_result_to_py(cr, self.categorical)
+        return pd.DataFrame(res, columns=fields)
+
+
 cdef class _FullBackend:
 
     def __cinit__(self):
@@ -203,7 +314,7 @@ cdef class _FullBackend:
         del cpp_ptx
         self.ptx = NULL
 
-    def query(self, table, conds=None):
+    def query(self, table, conds=None, categorical=False, columns=None):
         """Queries a database table.
 
         Parameters
@@ -212,6 +323,12 @@ cdef class _FullBackend:
             The table name.
         conds : iterable, optional
             A list of conditions.
+        categorical : bool, optional
+            Return string and uuid columns as pandas Categoricals.
+        columns : iterable of str, optional
+            The columns to return, in order. Only these columns are read from
+            the database. Conditions may use any column. Defaults to all
+            columns.
 
         Returns
         -------
@@ -219,34 +336,64 @@ cdef class _FullBackend:
             Pandas DataFrame the represents the table
         """
         cdef std_string tab = str(table).encode()
-        cdef std_string field
-        cdef cpp_cyclus.QueryResult qr
+        cdef cpp_cyclus.ColumnarResult cr
         cdef std_vector[cpp_cyclus.Cond] cpp_conds
-        cdef std_vector[cpp_cyclus.Cond]* conds_ptx
-        cdef std_map[std_string, cpp_cyclus.DbTypes] coltypes
-        # set up the conditions
-        if conds is None:
-            conds_ptx = NULL
-        else:
-            coltypes = (<cpp_cyclus.FullBackend*> self.ptx).ColumnTypes(tab)
-            for cond in conds:
-                cond0 = cond[0].encode()
-                cond1 = cond[1].encode()
-                field = std_string(<const char*> cond0)
-                if coltypes.count(field) == 0:
-                    continue  # skips non-existent columns
-                cpp_conds.push_back(cpp_cyclus.Cond(field, cond1,
-                    py_to_any(cond[2], coltypes[field])))
-            if cpp_conds.size() == 0:
-                conds_ptx = NULL
-            else:
-                conds_ptx = &cpp_conds
+        cdef std_vector[cpp_cyclus.Cond]* conds_ptx = NULL
+        cdef std_vector[std_string] cpp_cols
+        cdef std_vector[std_string]* cols_ptx = NULL
+        if conds_py_to_cpp(<cpp_cyclus.FullBackend*> self.ptx, tab, conds,
+                           &cpp_conds):
+            conds_ptx = &cpp_conds
+        if cols_py_to_cpp(columns, &cpp_cols):
+            cols_ptx = &cpp_cols
         # query, convert, and return
-        qr = (<cpp_cyclus.FullBackend*> self.ptx).Query(tab, conds_ptx)
-        res, fields = query_result_to_py(qr)
+        cr = (<cpp_cyclus.FullBackend*> self.ptx).QueryColumns(tab, conds_ptx,
+                                                               cols_ptx)
+        res, fields = columnar_result_to_py(cr, categorical)
         results = pd.DataFrame(res, columns=fields)
         return results
 
+    def cursor(self, table, conds=None, batch_size=100000, categorical=False,
+               columns=None):
+        """Queries a database table in batches, so that tables which don't fit
+        into memory can be scanned.
+
+        Parameters
+        ----------
+        table : str
+            The table name.
+        conds : iterable, optional
+            A list of conditions.
+        batch_size : int, optional
+            The maximum number of rows per batch.
+        categorical : bool, optional
+            Return string and uuid columns as pandas Categoricals.
+        columns : iterable of str, optional
+            The columns to return, see query().
+
+        Returns
+        -------
+        batches : iterator of pd.DataFrame
+            Yields DataFrames of consecutive rows of the query result.
+        """
+        cdef std_string tab = str(table).encode()
+        cdef std_vector[cpp_cyclus.Cond] cpp_conds
+        cdef std_vector[cpp_cyclus.Cond]* conds_ptx = NULL
+        cdef std_vector[std_string] cpp_cols
+        cdef std_vector[std_string]* cols_ptx = NULL
+        if conds_py_to_cpp(<cpp_cyclus.FullBackend*> self.ptx, tab, conds,
+                           &cpp_conds):
+            conds_ptx = &cpp_conds
+        if cols_py_to_cpp(columns, &cpp_cols):
+            cols_ptx = &cpp_cols
+        cdef _QueryCursor c = _QueryCursor()
+        c.ptx = (<cpp_cyclus.FullBackend*> self.ptx).Cursor(tab, conds_ptx,
+                                                            cols_ptx)
+        c.backend = self
+        c.batch_size = batch_size
+        c.categorical = categorical
+        return c
+
     def schema(self, table):
         cdef std_string ctable = str_py_to_cpp(table)
         cdef std_list[cpp_cyclus.ColumnInfo] cis = (<cpp_cyclus.QueryableBackend*> self.ptx).Schema(ctable)
@@ -361,6 +508,42 @@ class Hdf5Back(_Hdf5Back, FullBackend):
     """HDF5 backend cyclus database interface."""
 
 
+cdef class _ColumnarBack(_FullBackend):
+
+    def __cinit__(self, path):
+        """Columnar backend C++ constructor"""
+        cdef std_string cpp_path = str(path).encode()
+        self.ptx = new cpp_cyclus.ColumnarBack(cpp_path)
+
+    def __dealloc__(self):
+        """Full backend C++ destructor."""
+        # Note that we have to do it this way since self.ptx is void*
+        if self.ptx == NULL:
+            return
+        cdef cpp_cyclus.ColumnarBack * cpp_ptx = <cpp_cyclus.ColumnarBack *> self.ptx
+        del cpp_ptx
+        self.ptx = NULL
+
+    def flush(self):
+        """Writes the buffered rows to disk."""
+        (<cpp_cyclus.ColumnarBack*> self.ptx).Flush()
+
+    def close(self):
+        """Closes the backend, flushing it in the process."""
+        (<cpp_cyclus.ColumnarBack*> self.ptx).Close()
+
+    @property
+    def name(self):
+        """The name of the database."""
+        name = (<cpp_cyclus.ColumnarBack*> self.ptx).Name()
+        name = name.decode()
+        return name
+
+
+class ColumnarBack(_ColumnarBack, FullBackend):
+    """Columnar file backend cyclus database interface."""
+
+
 cdef class _Recorder:
 
     def __cinit__(self, bint inject_sim_id=True):
@@ -416,6 +599,9 @@ cdef class _Recorder:
         elif isinstance(backend, SqliteBack):
             b = <cpp_cyclus.RecBackend*> (
                 <cpp_cyclus.SqliteBack*> (<_SqliteBack> backend).ptx)
+        elif isinstance(backend, ColumnarBack):
+            b = <cpp_cyclus.RecBackend*> (
+                <cpp_cyclus.ColumnarBack*> (<_ColumnarBack> backend).ptx)
         elif isinstance(backend, FullBackend):
             b = <cpp_cyclus.RecBackend*> ((<_FullBackend> backend).ptx)
         else:
@@ -1971,7 +2157,8 @@ def call_listeners(tsname, agent, time, value):
         f(agent, time, value, tsname)
 
 
-EXT_BACKENDS = {'.h5': Hdf5Back, '.sqlite': SqliteBack}
+EXT_BACKENDS = {'.h5': Hdf5Back, '.sqlite': SqliteBack,
+                '.cyccol': ColumnarBack}
 
 def dbopen(fname):
     """Opens a Cyclus database."""
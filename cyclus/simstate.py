@@ -10,7 +10,7 @@ from cyclus.lib import (DynamicModule, Env, version, load_string_from_file,
     Recorder, Timer, Context, set_warn_limit, discover_specs, XMLParser,
     discover_specs_in_cyclus_path, discover_metadata_in_cyclus_path, Logger,
     set_warn_limit, set_warn_as_error, xml_to_json, json_to_xml,
-    Hdf5Back, SqliteBack, InfileTree, SimInit, XMLFileLoader, XMLFlatLoader)
+    Hdf5Back, SqliteBack, ColumnarBack, InfileTree, SimInit, XMLFileLoader, XMLFlatLoader)
 from cyclus.memback import MemBack
 
 
@@ -147,6 +147,8 @@ class SimState(object):
             self.file_backend = Hdf5Back(output_path)
         elif ext == '.sqlite':
             self.file_backend = SqliteBack(output_path)
+        elif ext == '.cyccol':
+            self.file_backend = ColumnarBack(output_path)
         else:
             raise RuntimeError('Backend extension type not recognised, ' +
                                output_path)
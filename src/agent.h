@@ -329,6 +329,16 @@ class Agent : public StateWrangler, virtual public Ider {
   /// default implementation for material preferences.
   virtual void AdjustProductPrefs(PrefMap<Product>::type& prefs) {}
 
+  /// Returns true if this agent's AdjustMatlPrefs and AdjustProductPrefs may
+  /// be called concurrently for the preferences of different requesters (its
+  /// children) when the threaded resource exchange is enabled. Agents
+  /// returning true must only modify the preferences they are given, and must
+  /// not depend on the order in which their children's preferences are
+  /// adjusted. Defaults to false.
+  virtual bool ThreadSafePrefs() {
+    return false;
+  }
+
   /// Returns an agent's xml rng schema for initializing from input files. All
   /// concrete agents should override this function. This must validate the same
   /// xml input that the InfileToDb function receives.
@@ -40,6 +40,31 @@ template <class T> class Bid {
     return new Bid<T>(request, offer, bidder, portfolio, exclusive, preference);
   }
 
+  /// @brief a factory method for a bid of several identical exclusive offers
+  /// @param request the request being responded to by this bid
+  /// @param offer one of the offered resources
+  /// @param bidder the bidder
+  /// @param portfolio the porftolio of which this bid is a part
+  /// @param exclusive flag for whether the bid is exclusive
+  /// @param preference specifies the preference of a bid in a request
+  ///        to bid arc. If NaN the request preference is used.
+  /// @param multiplicity the number of offers, each of which can only be
+  ///        traded in its entirety (the bid must be exclusive if this is
+  ///        greater than one)
+  inline static Bid<T>* Create(Request<T>* request,
+                               boost::shared_ptr<T>
+                                   offer,
+                               Trader* bidder,
+                               typename BidPortfolio<T>::Ptr portfolio,
+                               bool exclusive,
+                               double preference,
+                               int multiplicity) {
+    Bid<T>* b =
+        new Bid<T>(request, offer, bidder, portfolio, exclusive, preference);
+    b->multiplicity_ = multiplicity;
+    return b;
+  }
+
   /// @brief a factory method for a bid
   /// @param request the request being responded to by this bid
   /// @param offer the resource being offered in response to the request
@@ -88,6 +113,11 @@ template <class T> class Bid {
   /// @return the preference of this bid
   inline double preference() const { return preference_; }
 
+  /// @return the number of identical exclusive offers this bid stands for.
+  /// Each is traded separately, i.e., a bid with multiplicity n is equivalent
+  /// to n exclusive bids of the same offer.
+  inline int multiplicity() const { return multiplicity_; }
+
  private:
   /// @brief constructors are private to require use of factory methods
   Bid(Request<T>* request, boost::shared_ptr<T> offer, Trader* bidder,
@@ -96,7 +126,8 @@ template <class T> class Bid {
         offer_(offer),
         bidder_(bidder),
         exclusive_(exclusive),
-        preference_(preference) {}
+        preference_(preference),
+        multiplicity_(1) {}
   /// @brief constructors are private to require use of factory methods
   Bid(Request<T>* request, boost::shared_ptr<T> offer, Trader* bidder,
       bool exclusive = false)
@@ -104,7 +135,8 @@ template <class T> class Bid {
         offer_(offer),
         bidder_(bidder),
         exclusive_(exclusive),
-        preference_(std::numeric_limits<double>::quiet_NaN()) {}
+        preference_(std::numeric_limits<double>::quiet_NaN()),
+        multiplicity_(1) {}
 
   Bid(Request<T>* request, boost::shared_ptr<T> offer, Trader* bidder,
       typename BidPortfolio<T>::Ptr portfolio, bool exclusive, double preference)
@@ -113,7 +145,8 @@ template <class T> class Bid {
         bidder_(bidder),
         portfolio_(portfolio),
         exclusive_(exclusive),
-        preference_(preference) {}
+        preference_(preference),
+        multiplicity_(1) {}
 
   Bid(Request<T>* request, boost::shared_ptr<T> offer, Trader* bidder,
       typename BidPortfolio<T>::Ptr portfolio, bool exclusive = false)
@@ -122,7 +155,8 @@ template <class T> class Bid {
         bidder_(bidder),
         portfolio_(portfolio),
         exclusive_(exclusive),
-        preference_(std::numeric_limits<double>::quiet_NaN()) {}
+        preference_(std::numeric_limits<double>::quiet_NaN()),
+        multiplicity_(1) {}
 
   Request<T>* request_;
   boost::shared_ptr<T> offer_;
@@ -130,6 +164,7 @@ template <class T> class Bid {
   boost::weak_ptr<BidPortfolio<T>> portfolio_;
   bool exclusive_;
   double preference_;
+  int multiplicity_;
 };
 
 }  // namespace cyclus
@@ -55,8 +55,34 @@ class BidPortfolio : public boost::enable_shared_from_this<BidPortfolio<T>> {
   /// original
   Bid<T>* AddBid(Request<T>* request, boost::shared_ptr<T> offer,
                  Trader* bidder, bool exclusive, double preference) {
+    return AddBid(request, offer, bidder, exclusive, preference, 1);
+  }
+
+  /// @brief add a bid of several identical exclusive offers to the
+  /// portfolio. This is equivalent to, but much cheaper to solve than, adding
+  /// multiplicity exclusive bids of the same offer.
+  /// @param request the request being responded to by this bid
+  /// @param offer one of the offered resources
+  /// @param bidder the bidder
+  /// @param exclusive indicates whether the bid is exclusive
+  /// @param preference sets the preference of the bid on a request
+  ///        bid arc.
+  /// @param multiplicity the number of offers
+  /// @throws KeyError if a bid is added from a different bidder than the
+  /// original
+  /// @throws ValueError if multiplicity is less than one, or greater than one
+  /// for a non-exclusive bid
+  Bid<T>* AddBid(Request<T>* request, boost::shared_ptr<T> offer,
+                 Trader* bidder, bool exclusive, double preference,
+                 int multiplicity) {
+    if (multiplicity < 1 || (multiplicity > 1 && !exclusive)) {
+      std::stringstream ss;
+      ss << GetTraderPrototype(bidder) << " from " << GetTraderSpec(bidder)
+         << " is offering an invalid number of bids, N = " << multiplicity;
+      throw ValueError(ss.str());
+    }
     Bid<T>* b = Bid<T>::Create(request, offer, bidder, this->shared_from_this(),
-                               exclusive, preference);
+                               exclusive, preference, multiplicity);
     VerifyResponder_(b);
     if (offer->quantity() > 0)
       bids_.insert(b);
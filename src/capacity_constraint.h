@@ -1,6 +1,10 @@
 #ifndef CYCLUS_SRC_CAPACITY_CONSTRAINT_H_
 #define CYCLUS_SRC_CAPACITY_CONSTRAINT_H_
 
+#include <atomic>
+#include <map>
+#include <utility>
+
 #include <boost/shared_ptr.hpp>
 
 #include "error.h"
@@ -27,6 +31,15 @@ struct Converter {
       Arc const * a = NULL,
       ExchangeTranslationContext<T> const * ctx = NULL) const = 0;
 
+  /// @brief whether convert() depends only on the offer's quality (i.e., its
+  /// qual_id()) and quantity, and not on the arc or context. The results of
+  /// pure converters are reused for offers of the same quality and quantity
+  /// during the translation of an exchange. Converters are not pure by
+  /// default.
+  virtual bool pure() const {
+    return false;
+  }
+
   /// @brief operator== is available for subclassing, see
   /// cyclus::TrivialConverter for an example
   virtual bool operator==(Converter& other) const {
@@ -50,6 +63,11 @@ struct TrivialConverter : public Converter<T> {
     return offer->quantity();
   }
 
+  /// @returns true
+  virtual bool pure() const {
+    return true;
+  }
+
   /// @returns true if a dynamic cast succeeds
   virtual bool operator==(Converter<T>& other) const {
     return dynamic_cast<TrivialConverter<T>*>(&other) != NULL;
@@ -98,11 +116,26 @@ class CapacityConstraint {
     return converter_;
   }
 
+  /// @return the converted offer, which is taken from ctx if the converter is
+  /// pure and has already converted an offer of the same quality and
+  /// quantity in ctx
   inline double convert(
       boost::shared_ptr<T> offer,
       Arc const * a = NULL,
       ExchangeTranslationContext<T> const * ctx = NULL) const {
-    return converter_->convert(offer, a, ctx);
+    if (ctx == NULL || !converter_->pure()) {
+      return converter_->convert(offer, a, ctx);
+    }
+
+    typename ExchangeTranslationContext<T>::ConvertKey key(
+        converter_.get(), std::make_pair(offer->qual_id(), offer->quantity()));
+    typename std::map<typename ExchangeTranslationContext<T>::ConvertKey,
+                      double>::iterator it = ctx->converted.find(key);
+    if (it == ctx->converted.end()) {
+      it = ctx->converted.insert(
+          std::make_pair(key, converter_->convert(offer, a, ctx))).first;
+    }
+    return it->second;
   }
 
   /// @return a unique id for the constraint
@@ -114,10 +147,10 @@ class CapacityConstraint {
   double capacity_;
   typename Converter<T>::Ptr converter_;
   int id_;
-  static int next_id_;
+  static std::atomic<int> next_id_;
 };
 
-template<class T> int CapacityConstraint<T>::next_id_ = 0;
+template<class T> std::atomic<int> CapacityConstraint<T>::next_id_(0);
 
 /// @brief CapacityConstraint-CapacityConstraint equality operator
 template<class T>
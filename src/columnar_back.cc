@@ -0,0 +1,881 @@
+#include "columnar_back.h"
+
+#include <algorithm>
+#include <cstring>
+#include <list>
+#include <set>
+#include <sstream>
+#include <typeindex>
+
+#include <boost/archive/binary_iarchive.hpp>
+#include <boost/archive/binary_oarchive.hpp>
+#include <boost/filesystem.hpp>
+#include <boost/serialization/list.hpp>
+#include <boost/serialization/map.hpp>
+#include <boost/serialization/set.hpp>
+#include <boost/serialization/utility.hpp>
+#include <boost/serialization/vector.hpp>
+
+#include "blob.h"
+#include "datum.h"
+#include "error.h"
+
+namespace fs = boost::filesystem;
+
+namespace cyclus {
+
+// identifies columnar table files, at their start and end
+static const char kMagic[] = "CYCCOL1\n";
+static const int kMagicLen = 8;
+static const char kExt[] = ".cyccol";
+
+// the container types that are recorded as serialized, length prefixed
+// values, calls X(dbtype, type) for each
+#define CYCLUS_COMMA ,
+#define CYCLUS_COLUMNAR_CONTAINERS(X)                                        \
+  X(SET_INT, std::set<int>)                                                  \
+  X(SET_STRING, std::set<std::string>)                                       \
+  X(LIST_INT, std::list<int>)                                                \
+  X(LIST_STRING, std::list<std::string>)                                     \
+  X(VECTOR_INT, std::vector<int>)                                            \
+  X(VECTOR_DOUBLE, std::vector<double>)                                      \
+  X(VECTOR_STRING, std::vector<std::string>)                                 \
+  X(MAP_INT_DOUBLE, std::map<int CYCLUS_COMMA double>)                       \
+  X(MAP_INT_INT, std::map<int CYCLUS_COMMA int>)                             \
+  X(MAP_INT_STRING, std::map<int CYCLUS_COMMA std::string>)                  \
+  X(MAP_STRING_INT, std::map<std::string CYCLUS_COMMA int>)                  \
+  X(MAP_STRING_DOUBLE, std::map<std::string CYCLUS_COMMA double>)            \
+  X(MAP_STRING_STRING, std::map<std::string CYCLUS_COMMA std::string>)       \
+  X(MAP_STRING_VECTOR_DOUBLE,                                                \
+    std::map<std::string CYCLUS_COMMA std::vector<double> >)                 \
+  X(MAP_STRING_MAP_INT_DOUBLE,                                               \
+    std::map<std::string CYCLUS_COMMA std::map<int CYCLUS_COMMA double> >)   \
+  X(MAP_STRING_PAIR_DOUBLE_MAP_INT_DOUBLE,                                   \
+    std::map<std::string CYCLUS_COMMA                                        \
+             std::pair<double CYCLUS_COMMA                                   \
+                       std::map<int CYCLUS_COMMA double> > >)                \
+  X(MAP_INT_MAP_STRING_DOUBLE,                                               \
+    std::map<int CYCLUS_COMMA std::map<std::string CYCLUS_COMMA double> >)   \
+  X(MAP_STRING_VECTOR_PAIR_INT_PAIR_STRING_STRING,                           \
+    std::map<std::string CYCLUS_COMMA                                        \
+             std::vector<std::pair<int CYCLUS_COMMA                          \
+                                   std::pair<std::string CYCLUS_COMMA        \
+                                             std::string> > > >)             \
+  X(MAP_STRING_PAIR_STRING_VECTOR_DOUBLE,                                    \
+    std::map<std::string CYCLUS_COMMA                                        \
+             std::pair<std::string CYCLUS_COMMA std::vector<double> > >)     \
+  X(LIST_PAIR_INT_INT, std::list<std::pair<int CYCLUS_COMMA int> >)          \
+  X(MAP_STRING_MAP_STRING_INT,                                               \
+    std::map<std::string CYCLUS_COMMA                                        \
+             std::map<std::string CYCLUS_COMMA int> >)                       \
+  X(VECTOR_PAIR_PAIR_DOUBLE_DOUBLE_MAP_STRING_DOUBLE,                        \
+    std::vector<std::pair<std::pair<double CYCLUS_COMMA double> CYCLUS_COMMA \
+                          std::map<std::string CYCLUS_COMMA double> > >)     \
+  X(MAP_PAIR_STRING_STRING_INT,                                              \
+    std::map<std::pair<std::string CYCLUS_COMMA std::string> CYCLUS_COMMA    \
+             int>)
+
+namespace {
+
+template <class T>
+void Put(std::ostream& os, const T& v) {
+  os.write(reinterpret_cast<const char*>(&v), sizeof(T));
+}
+
+void PutStr(std::ostream& os, const std::string& s) {
+  Put<uint32_t>(os, s.size());
+  os.write(s.data(), s.size());
+}
+
+template <class T>
+T Get(std::istream& is) {
+  T v;
+  is.read(reinterpret_cast<char*>(&v), sizeof(T));
+  return v;
+}
+
+std::string GetStr(std::istream& is) {
+  std::string s(Get<uint32_t>(is), '\0');
+  if (!s.empty()) {
+    is.read(&s[0], s.size());
+  }
+  return s;
+}
+
+bool IsIntCol(DbTypes type) {
+  return type == INT || type == BOOL;
+}
+
+typedef std::map<std::type_index, DbTypes> TypeMap;
+
+const TypeMap& ContainerTypes() {
+  static const TypeMap types = [] {
+    TypeMap m;
+#define CYCLUS_ADDTYPE(D, T) m[std::type_index(typeid(T))] = D;
+    CYCLUS_COLUMNAR_CONTAINERS(CYCLUS_ADDTYPE)
+#undef CYCLUS_ADDTYPE
+    return m;
+  }();
+  return types;
+}
+
+// serializes v, which holds a container of type type
+std::string EncodeContainer(const boost::spirit::hold_any& v, DbTypes type) {
+  std::stringstream ss;
+  {
+    // the archive must be closed before the stream is read
+    boost::archive::binary_oarchive ar(ss);
+    switch (type) {
+#define CYCLUS_SAVEVAL(D, T) \
+      case D: {              \
+        const T& x = v.cast<T>(); \
+        ar << x;             \
+        break;               \
+      }
+      CYCLUS_COLUMNAR_CONTAINERS(CYCLUS_SAVEVAL)
+#undef CYCLUS_SAVEVAL
+      default:
+        throw ValueError("ColumnarBack can't serialize this column type");
+    }
+  }
+  return ss.str();
+}
+
+// deserializes a container of type type from s
+boost::spirit::hold_any DecodeContainer(const std::string& s, DbTypes type) {
+  std::stringstream ss(s);
+  boost::archive::binary_iarchive ar(ss);
+  switch (type) {
+#define CYCLUS_LOADVAL(D, T) \
+    case D: {                \
+      T x;                   \
+      ar >> x;               \
+      return boost::spirit::hold_any(x); \
+    }
+    CYCLUS_COLUMNAR_CONTAINERS(CYCLUS_LOADVAL)
+#undef CYCLUS_LOADVAL
+    default:
+      throw ValueError("ColumnarBack can't deserialize this column type");
+  }
+}
+
+DbTypes ColType(const boost::spirit::hold_any& v) {
+  const std::type_info& t = v.type();
+  if (t == typeid(int)) {
+    return INT;
+  } else if (t == typeid(bool)) {
+    return BOOL;
+  } else if (t == typeid(double)) {
+    return DOUBLE;
+  } else if (t == typeid(float)) {
+    return FLOAT;
+  } else if (t == typeid(std::string)) {
+    return STRING;
+  } else if (t == typeid(boost::uuids::uuid)) {
+    return UUID;
+  } else if (t == typeid(Blob)) {
+    return BLOB;
+  }
+  const TypeMap& containers = ContainerTypes();
+  TypeMap::const_iterator it = containers.find(std::type_index(t));
+  if (it != containers.end()) {
+    return it->second;
+  }
+  throw ValueError(std::string("ColumnarBack can't record values of type ") +
+                   t.name());
+}
+
+// returns row i of column c as a hold_any
+boost::spirit::hold_any ColVal(const QueryColumn& c, int i) {
+  switch (c.type) {
+    case INT:
+      return boost::spirit::hold_any(c.ints[i]);
+    case BOOL:
+      return boost::spirit::hold_any(c.ints[i] != 0);
+    case DOUBLE:
+      return boost::spirit::hold_any(c.doubles[i]);
+    case FLOAT:
+      return boost::spirit::hold_any(static_cast<float>(c.doubles[i]));
+    case STRING:
+      return boost::spirit::hold_any(c.strs[c.codes[i]]);
+    case UUID:
+      return boost::spirit::hold_any(c.uuids[c.codes[i]]);
+    default:
+      return c.vals[i];
+  }
+}
+
+// evaluates cond for the distinct values of a dictionary encoded column and
+// applies the results to the rows
+template <class T>
+void MatchDict(const std::vector<T>& dict, const std::vector<int>& codes,
+               Cond* cond, std::vector<bool>* mask) {
+  std::vector<bool> ok(dict.size());
+  for (int k = 0; k < dict.size(); ++k) {
+    T v = dict[k];
+    ok[k] = CmpCond<T>(&v, cond);
+  }
+  for (int i = 0; i < codes.size(); ++i) {
+    (*mask)[i] = (*mask)[i] && ok[codes[i]];
+  }
+}
+
+}  // namespace
+
+/// Decodes the pages of a table one at a time.  The pages to read are
+/// determined when the cursor is created, so rows recorded afterwards are not
+/// returned.
+class ColumnarCursor: public QueryCursor {
+ public:
+  ColumnarCursor(ColumnarBack* back, ColumnarBack::Table* t,
+                 std::vector<Cond>* conds, std::vector<std::string>* cols)
+      : back_(back),
+        t_(t),
+        page_(0),
+        npages_(t->pages.size()) {
+    if (conds != NULL) {
+      conds_ = *conds;
+    }
+    out_ = back->Columns(t, conds_, cols, &decode_);
+    for (int k = 0; k < out_.size(); ++k) {
+      info_.fields.push_back(t->fields[out_[k]]);
+      info_.types.push_back(t->types[out_[k]]);
+    }
+  }
+
+  virtual bool Fetch(int n, QueryResult* qr) {
+    qr->fields = info_.fields;
+    qr->types = info_.types;
+    qr->rows.clear();
+    qr->rows.swap(pending_);
+    for (; qr->rows.size() < n && page_ < npages_; ++page_) {
+      back_->AppendRows(t_, page_, conds_, out_, decode_, &qr->rows);
+    }
+    // keep the rest of the last page for the next fetch
+    if (qr->rows.size() > n) {
+      pending_.assign(qr->rows.begin() + n, qr->rows.end());
+      qr->rows.resize(n);
+    }
+    return !qr->rows.empty();
+  }
+
+ private:
+  ColumnarBack* back_;
+  ColumnarBack::Table* t_;
+  QueryResult info_;
+  std::vector<Cond> conds_;
+  std::vector<int> out_;
+  std::vector<bool> decode_;
+  int page_;
+  int npages_;
+  std::vector<QueryRow> pending_;
+};
+
+ColumnarBack::ColumnarBack(std::string path)
+    : path_(path),
+      page_rows_(64 * 1024) {
+  if (fs::exists(path_) && !fs::is_directory(path_)) {
+    throw IOError("'" + path_ + "' is not a directory.");
+  }
+  fs::create_directories(path_);
+}
+
+ColumnarBack::~ColumnarBack() {
+  try {
+    Flush();
+  } catch (Error err) {}
+  std::map<std::string, Table>::iterator it;
+  for (it = tables_.begin(); it != tables_.end(); ++it) {
+    delete it->second.file;
+  }
+}
+
+std::string ColumnarBack::Name() {
+  return path_;
+}
+
+void ColumnarBack::Notify(DatumList data) {
+  for (DatumList::iterator it = data.begin(); it != data.end(); ++it) {
+    Datum* d = *it;
+    Table* t = GetTable(d->title());
+    if (t == NULL) {
+      t = CreateTable(d);
+    }
+
+    const Datum::Vals& vals = d->vals();
+    if (vals.size() != t->fields.size()) {
+      throw ValueError("datum for table '" + d->title() +
+                       "' has the wrong number of values");
+    }
+    // the whole datum is checked before any column grows so that a rejected
+    // datum leaves the buffered columns the same length
+    for (int j = 0; j < vals.size(); ++j) {
+      if (t->fields[j] != vals[j].first ||
+          t->types[j] != ColType(vals[j].second)) {
+        throw ValueError("datum for table '" + d->title() +
+                         "' doesn't match the table's field '" +
+                         t->fields[j] + "'");
+      }
+    }
+    for (int j = 0; j < vals.size(); ++j) {
+      t->buf.columns[j].Append(vals[j].second);
+    }
+    if (++t->buf.nrows >= page_rows_) {
+      WritePage(t);
+    }
+  }
+}
+
+void ColumnarBack::Flush() {
+  std::map<std::string, Table>::iterator it;
+  for (it = tables_.begin(); it != tables_.end(); ++it) {
+    if (it->second.buf.nrows > 0) {
+      WritePage(&it->second);
+    }
+  }
+}
+
+void ColumnarBack::Close() {
+  Flush();
+}
+
+std::string ColumnarBack::FileName(std::string table) {
+  return (fs::path(path_) / (table + kExt)).string();
+}
+
+ColumnarBack::Table* ColumnarBack::GetTable(std::string table) {
+  std::map<std::string, Table>::iterator it = tables_.find(table);
+  if (it != tables_.end()) {
+    return &it->second;
+  }
+
+  std::string fname = FileName(table);
+  if (!fs::exists(fname)) {
+    return NULL;
+  }
+  std::fstream* f = new std::fstream(
+      fname.c_str(), std::ios::in | std::ios::out | std::ios::binary);
+  char magic[kMagicLen];
+  f->seekg(-(kMagicLen + (int)sizeof(uint64_t)), std::ios::end);
+  uint64_t footer_pos = Get<uint64_t>(*f);
+  f->read(magic, kMagicLen);
+  if (!*f || std::memcmp(magic, kMagic, kMagicLen) != 0) {
+    delete f;
+    throw IOError("'" + fname + "' is not a columnar table file.");
+  }
+
+  Table& t = tables_[table];
+  t.name = table;
+  t.file = f;
+  t.footer_pos = footer_pos;
+  f->seekg(footer_pos);
+  uint32_t nfields = Get<uint32_t>(*f);
+  int nints = 0;
+  for (int j = 0; j < nfields; ++j) {
+    t.fields.push_back(GetStr(*f));
+    t.types.push_back(static_cast<DbTypes>(Get<int32_t>(*f)));
+    t.buf.columns.push_back(QueryColumn(t.fields[j], t.types[j]));
+    nints += IsIntCol(t.types[j]);
+  }
+  uint32_t npages = Get<uint32_t>(*f);
+  t.pages.resize(npages);
+  for (int p = 0; p < npages; ++p) {
+    PageInfo& page = t.pages[p];
+    page.offset = Get<uint64_t>(*f);
+    page.nrows = Get<int32_t>(*f);
+    for (int j = 0; j < nfields; ++j) {
+      page.sizes.push_back(Get<uint64_t>(*f));
+    }
+    for (int k = 0; k < nints; ++k) {
+      page.mins.push_back(Get<int32_t>(*f));
+      page.maxs.push_back(Get<int32_t>(*f));
+    }
+  }
+  if (!*f) {
+    throw IOError("failed to read the footer of '" + fname + "'.");
+  }
+  return &t;
+}
+
+ColumnarBack::Table* ColumnarBack::CreateTable(Datum* d) {
+  // rejects unsupported types before anything is created
+  const Datum::Vals& vals = d->vals();
+  std::vector<DbTypes> types;
+  for (int j = 0; j < vals.size(); ++j) {
+    types.push_back(ColType(vals[j].second));
+  }
+
+  std::string fname = FileName(d->title());
+  std::fstream* f = new std::fstream(
+      fname.c_str(),
+      std::ios::in | std::ios::out | std::ios::trunc | std::ios::binary);
+  if (!*f) {
+    delete f;
+    throw IOError("failed to create '" + fname + "'.");
+  }
+  f->write(kMagic, kMagicLen);
+
+  Table& t = tables_[d->title()];
+  t.name = d->title();
+  t.file = f;
+  t.footer_pos = kMagicLen;
+  t.types = types;
+  for (int j = 0; j < vals.size(); ++j) {
+    t.fields.push_back(vals[j].first);
+    t.buf.columns.push_back(QueryColumn(t.fields[j], t.types[j]));
+  }
+  // the file is readable, without pages, until the first page is written
+  WriteFooter(&t);
+  return &t;
+}
+
+void ColumnarBack::WritePage(Table* t) {
+  std::fstream& f = *t->file;
+  ColumnarResult& buf = t->buf;
+  PageInfo page;
+  page.offset = t->footer_pos;
+  page.nrows = buf.nrows;
+
+  // the page overwrites the previous footer
+  f.seekp(t->footer_pos);
+  for (int j = 0; j < buf.columns.size(); ++j) {
+    QueryColumn& c = buf.columns[j];
+    uint64_t start = f.tellp();
+    switch (c.type) {
+      case INT:  // fallthrough
+      case BOOL: {
+        f.write(reinterpret_cast<char*>(&c.ints[0]), c.ints.size() * 4);
+        page.mins.push_back(*std::min_element(c.ints.begin(), c.ints.end()));
+        page.maxs.push_back(*std::max_element(c.ints.begin(), c.ints.end()));
+        break;
+      }
+      case DOUBLE:  // fallthrough
+      case FLOAT: {
+        f.write(reinterpret_cast<char*>(&c.doubles[0]), c.doubles.size() * 8);
+        break;
+      }
+      case STRING: {
+        Put<uint32_t>(f, c.strs.size());
+        for (int k = 0; k < c.strs.size(); ++k) {
+          PutStr(f, c.strs[k]);
+        }
+        f.write(reinterpret_cast<char*>(&c.codes[0]), c.codes.size() * 4);
+        break;
+      }
+      case UUID: {
+        Put<uint32_t>(f, c.uuids.size());
+        for (int k = 0; k < c.uuids.size(); ++k) {
+          f.write(reinterpret_cast<char*>(c.uuids[k].data), CYCLUS_UUID_SIZE);
+        }
+        f.write(reinterpret_cast<char*>(&c.codes[0]), c.codes.size() * 4);
+        break;
+      }
+      case BLOB: {
+        for (int i = 0; i < c.vals.size(); ++i) {
+          PutStr(f, c.vals[i].cast<Blob>().str());
+        }
+        break;
+      }
+      default: {
+        for (int i = 0; i < c.vals.size(); ++i) {
+          PutStr(f, EncodeContainer(c.vals[i], c.type));
+        }
+      }
+    }
+    page.sizes.push_back(static_cast<uint64_t>(f.tellp()) - start);
+    c = QueryColumn(c.field, c.type);
+  }
+  buf.nrows = 0;
+  t->pages.push_back(page);
+  t->footer_pos = f.tellp();
+  WriteFooter(t);
+}
+
+void ColumnarBack::WriteFooter(Table* t) {
+  std::fstream& f = *t->file;
+  f.seekp(t->footer_pos);
+  Put<uint32_t>(f, t->fields.size());
+  for (int j = 0; j < t->fields.size(); ++j) {
+    PutStr(f, t->fields[j]);
+    Put<int32_t>(f, t->types[j]);
+  }
+  Put<uint32_t>(f, t->pages.size());
+  for (int p = 0; p < t->pages.size(); ++p) {
+    PageInfo& pi = t->pages[p];
+    Put<uint64_t>(f, pi.offset);
+    Put<int32_t>(f, pi.nrows);
+    for (int j = 0; j < pi.sizes.size(); ++j) {
+      Put<uint64_t>(f, pi.sizes[j]);
+    }
+    for (int k = 0; k < pi.mins.size(); ++k) {
+      Put<int32_t>(f, pi.mins[k]);
+      Put<int32_t>(f, pi.maxs[k]);
+    }
+  }
+  Put<uint64_t>(f, t->footer_pos);
+  f.write(kMagic, kMagicLen);
+  f.flush();
+  if (!f) {
+    throw IOError("failed to write to '" + FileName(t->name) + "'.");
+  }
+}
+
+void ColumnarBack::ReadPage(Table* t, int p, const std::vector<bool>& decode,
+                            std::vector<QueryColumn>* cols) {
+  std::fstream& f = *t->file;
+  const PageInfo& page = t->pages[p];
+  int nrows = page.nrows;
+  uint64_t pos = page.offset;
+  cols->clear();
+  for (int j = 0; j < t->fields.size(); ++j) {
+    cols->push_back(QueryColumn(t->fields[j], t->types[j]));
+    QueryColumn& c = cols->back();
+    pos += page.sizes[j];
+    if (!decode[j]) {
+      continue;
+    }
+    f.seekg(pos - page.sizes[j]);
+    switch (c.type) {
+      case INT:  // fallthrough
+      case BOOL: {
+        c.ints.resize(nrows);
+        f.read(reinterpret_cast<char*>(&c.ints[0]), nrows * 4);
+        break;
+      }
+      case DOUBLE:  // fallthrough
+      case FLOAT: {
+        c.doubles.resize(nrows);
+        f.read(reinterpret_cast<char*>(&c.doubles[0]), nrows * 8);
+        break;
+      }
+      case STRING: {
+        c.strs.resize(Get<uint32_t>(f));
+        for (int k = 0; k < c.strs.size(); ++k) {
+          c.strs[k] = GetStr(f);
+        }
+        c.codes.resize(nrows);
+        f.read(reinterpret_cast<char*>(&c.codes[0]), nrows * 4);
+        break;
+      }
+      case UUID: {
+        c.uuids.resize(Get<uint32_t>(f));
+        for (int k = 0; k < c.uuids.size(); ++k) {
+          f.read(reinterpret_cast<char*>(c.uuids[k].data), CYCLUS_UUID_SIZE);
+        }
+        c.codes.resize(nrows);
+        f.read(reinterpret_cast<char*>(&c.codes[0]), nrows * 4);
+        break;
+      }
+      case BLOB: {
+        for (int i = 0; i < nrows; ++i) {
+          c.vals.push_back(boost::spirit::hold_any(Blob(GetStr(f))));
+        }
+        break;
+      }
+      default: {
+        for (int i = 0; i < nrows; ++i) {
+          c.vals.push_back(DecodeContainer(GetStr(f), c.type));
+        }
+      }
+    }
+  }
+  if (!f) {
+    throw IOError("failed to read a page of '" + FileName(t->name) + "'.");
+  }
+}
+
+bool ColumnarBack::PageMayMatch(Table* t, int p,
+                                const std::vector<Cond>& conds) {
+  const PageInfo& page = t->pages[p];
+  for (int i = 0; i < conds.size(); ++i) {
+    const Cond& c = conds[i];
+    if (c.val.type() != typeid(int)) {
+      continue;
+    }
+    int k = 0;
+    int j = 0;
+    for (; j < t->fields.size() && t->fields[j] != c.field; ++j) {
+      k += IsIntCol(t->types[j]);
+    }
+    if (j == t->fields.size() || t->types[j] != INT) {
+      continue;
+    }
+    int v = c.val.cast<int>();
+    int lo = page.mins[k];
+    int hi = page.maxs[k];
+    if ((c.opcode == LT && lo >= v) || (c.opcode == LE && lo > v) ||
+        (c.opcode == GT && hi <= v) || (c.opcode == GE && hi < v) ||
+        (c.opcode == EQ && (v < lo || v > hi))) {
+      return false;
+    }
+  }
+  return true;
+}
+
+std::vector<bool> ColumnarBack::Matches(Table* t,
+                                        const std::vector<QueryColumn>& cols,
+                                        int nrows,
+                                        const std::vector<Cond>& conds) {
+  std::vector<bool> mask(nrows, true);
+  for (int i = 0; i < conds.size(); ++i) {
+    Cond cond = conds[i];
+    int j = std::find(t->fields.begin(), t->fields.end(), cond.field) -
+            t->fields.begin();
+    if (j == t->fields.size()) {
+      throw ValueError("table has no column '" + cond.field + "'");
+    }
+    const QueryColumn& c = cols[j];
+    switch (c.type) {
+      case INT: {
+        for (int r = 0; r < nrows; ++r) {
+          int v = c.ints[r];
+          mask[r] = mask[r] && CmpCond<int>(&v, &cond);
+        }
+        break;
+      }
+      case BOOL: {
+        for (int r = 0; r < nrows; ++r) {
+          bool v = c.ints[r] != 0;
+          mask[r] = mask[r] && CmpCond<bool>(&v, &cond);
+        }
+        break;
+      }
+      case DOUBLE: {
+        for (int r = 0; r < nrows; ++r) {
+          double v = c.doubles[r];
+          mask[r] = mask[r] && CmpCond<double>(&v, &cond);
+        }
+        break;
+      }
+      case FLOAT: {
+        for (int r = 0; r < nrows; ++r) {
+          float v = c.doubles[r];
+          mask[r] = mask[r] && CmpCond<float>(&v, &cond);
+        }
+        break;
+      }
+      case STRING: {
+        MatchDict<std::string>(c.strs, c.codes, &cond, &mask);
+        break;
+      }
+      case UUID: {
+        MatchDict<boost::uuids::uuid>(c.uuids, c.codes, &cond, &mask);
+        break;
+      }
+      case BLOB: {
+        for (int r = 0; r < nrows; ++r) {
+          Blob v = c.vals[r].cast<Blob>();
+          mask[r] = mask[r] && CmpCond<Blob>(&v, &cond);
+        }
+        break;
+      }
+      default: {
+        throw ValueError("can't apply conditions to the container column '" +
+                         cond.field + "'");
+      }
+    }
+  }
+  return mask;
+}
+
+void ColumnarBack::AppendRows(Table* t, int p, const std::vector<Cond>& conds,
+                              const std::vector<int>& out,
+                              const std::vector<bool>& decode,
+                              std::vector<QueryRow>* rows) {
+  if (!PageMayMatch(t, p, conds)) {
+    return;
+  }
+  std::vector<QueryColumn> cols;
+  ReadPage(t, p, decode, &cols);
+  int nrows = t->pages[p].nrows;
+  std::vector<bool> mask = Matches(t, cols, nrows, conds);
+  for (int i = 0; i < nrows; ++i) {
+    if (!mask[i]) {
+      continue;
+    }
+    QueryRow row(out.size());
+    for (int k = 0; k < out.size(); ++k) {
+      row[k] = ColVal(cols[out[k]], i);
+    }
+    rows->push_back(row);
+  }
+}
+
+std::vector<int> ColumnarBack::Columns(Table* t,
+                                       const std::vector<Cond>& conds,
+                                       std::vector<std::string>* cols,
+                                       std::vector<bool>* decode) {
+  if (cols == NULL) {
+    decode->assign(t->fields.size(), true);
+    std::vector<int> out(t->fields.size());
+    for (int j = 0; j < out.size(); ++j) {
+      out[j] = j;
+    }
+    return out;
+  }
+
+  std::vector<int> out = FieldIndexes(t->fields, *cols);
+  decode->assign(t->fields.size(), false);
+  for (int k = 0; k < out.size(); ++k) {
+    (*decode)[out[k]] = true;
+  }
+  for (int i = 0; i < conds.size(); ++i) {
+    std::vector<std::string>::iterator it =
+        std::find(t->fields.begin(), t->fields.end(), conds[i].field);
+    if (it != t->fields.end()) {
+      (*decode)[it - t->fields.begin()] = true;
+    }
+  }
+  return out;
+}
+
+ColumnarBack::Table* ColumnarBack::ReadTable(std::string table) {
+  Table* t = GetTable(table);
+  if (t == NULL) {
+    throw IOError("table '" + table + "' does not exist in '" + path_ + "'.");
+  }
+  if (t->buf.nrows > 0) {
+    WritePage(t);
+  }
+  return t;
+}
+
+QueryResult ColumnarBack::Query(std::string table, std::vector<Cond>* conds) {
+  return Query(table, conds, NULL);
+}
+
+QueryResult ColumnarBack::Query(std::string table, std::vector<Cond>* conds,
+                                std::vector<std::string>* cols) {
+  QueryResult qr;
+  Cursor(table, conds, cols)->Fetch(INT_MAX, &qr);
+  return qr;
+}
+
+QueryCursor::Ptr ColumnarBack::Cursor(std::string table,
+                                      std::vector<Cond>* conds) {
+  return Cursor(table, conds, NULL);
+}
+
+QueryCursor::Ptr ColumnarBack::Cursor(std::string table,
+                                      std::vector<Cond>* conds,
+                                      std::vector<std::string>* cols) {
+  Table* t = ReadTable(table);
+  return QueryCursor::Ptr(new ColumnarCursor(this, t, conds, cols));
+}
+
+ColumnarResult ColumnarBack::QueryColumns(std::string table,
+                                          std::vector<Cond>* conds) {
+  return QueryColumns(table, conds, NULL);
+}
+
+ColumnarResult ColumnarBack::QueryColumns(std::string table,
+                                          std::vector<Cond>* conds,
+                                          std::vector<std::string>* cols) {
+  Table* t = ReadTable(table);
+  std::vector<Cond> none;
+  const std::vector<Cond>& cs = conds == NULL ? none : *conds;
+  std::vector<bool> decode;
+  std::vector<int> outcols = Columns(t, cs, cols, &decode);
+
+  ColumnarResult cr;
+  for (int k = 0; k < outcols.size(); ++k) {
+    int j = outcols[k];
+    cr.columns.push_back(QueryColumn(t->fields[j], t->types[j]));
+  }
+  std::vector<QueryColumn> pcols;
+  for (int p = 0; p < t->pages.size(); ++p) {
+    if (!PageMayMatch(t, p, cs)) {
+      continue;
+    }
+    ReadPage(t, p, decode, &pcols);
+    int nrows = t->pages[p].nrows;
+    std::vector<bool> mask = Matches(t, pcols, nrows, cs);
+    for (int k = 0; k < outcols.size(); ++k) {
+      QueryColumn& in = pcols[outcols[k]];
+      QueryColumn& out = cr.columns[k];
+      // dictionary codes of the page are translated to the result's codes
+      // once per distinct value
+      std::vector<int> remap(std::max(in.strs.size(), in.uuids.size()), -1);
+      for (int i = 0; i < nrows; ++i) {
+        if (!mask[i]) {
+          continue;
+        }
+        switch (in.type) {
+          case INT:  // fallthrough
+          case BOOL:
+            out.ints.push_back(in.ints[i]);
+            break;
+          case DOUBLE:  // fallthrough
+          case FLOAT:
+            out.doubles.push_back(in.doubles[i]);
+            break;
+          case STRING:  // fallthrough
+          case UUID: {
+            int& code = remap[in.codes[i]];
+            if (code >= 0) {
+              out.codes.push_back(code);
+            } else if (in.type == STRING) {
+              out.AppendStr(in.strs[in.codes[i]]);
+              code = out.codes.back();
+            } else {
+              out.AppendUuid(in.uuids[in.codes[i]]);
+              code = out.codes.back();
+            }
+            break;
+          }
+          default:
+            out.vals.push_back(in.vals[i]);
+        }
+      }
+    }
+    for (int i = 0; i < nrows; ++i) {
+      cr.nrows += mask[i];
+    }
+  }
+  return cr;
+}
+
+std::map<std::string, DbTypes> ColumnarBack::ColumnTypes(std::string table) {
+  Table* t = GetTable(table);
+  if (t == NULL) {
+    throw IOError("table '" + table + "' does not exist in '" + path_ + "'.");
+  }
+  std::map<std::string, DbTypes> rtn;
+  for (int j = 0; j < t->fields.size(); ++j) {
+    rtn[t->fields[j]] = t->types[j];
+  }
+  return rtn;
+}
+
+std::list<ColumnInfo> ColumnarBack::Schema(std::string table) {
+  Table* t = GetTable(table);
+  if (t == NULL) {
+    throw IOError("table '" + table + "' does not exist in '" + path_ + "'.");
+  }
+  std::list<ColumnInfo> schema;
+  for (int j = 0; j < t->fields.size(); ++j) {
+    schema.push_back(ColumnInfo(table, t->fields[j], j, t->types[j],
+                                std::vector<int>()));
+  }
+  return schema;
+}
+
+std::set<std::string> ColumnarBack::Tables() {
+  std::set<std::string> rtn;
+  std::map<std::string, Table>::iterator it;
+  for (it = tables_.begin(); it != tables_.end(); ++it) {
+    rtn.insert(it->first);
+  }
+  fs::directory_iterator end;
+  for (fs::directory_iterator f(path_); f != end; ++f) {
+    if (f->path().extension().string() == kExt) {
+      rtn.insert(f->path().stem().string());
+    }
+  }
+  return rtn;
+}
+
+#undef CYCLUS_COLUMNAR_CONTAINERS
+#undef CYCLUS_COMMA
+
+}  // namespace cyclus
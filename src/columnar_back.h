@@ -0,0 +1,169 @@
+#ifndef CYCLUS_SRC_COLUMNAR_BACK_H_
+#define CYCLUS_SRC_COLUMNAR_BACK_H_
+
+#include <fstream>
+#include <list>
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "query_backend.h"
+
+namespace cyclus {
+
+/// A backend that writes each table to its own append-only columnar file in
+/// a directory.  Rows are buffered per table and written in pages of up to
+/// page_rows() rows.  Within a page the values of each column are stored
+/// contiguously: INT and BOOL columns as 32 bit integers, FLOAT and DOUBLE
+/// columns as doubles, STRING, VL_STRING and UUID columns dictionary encoded
+/// (the page's distinct values followed by one 32 bit code per row) and BLOB
+/// columns as length prefixed bytes.  Columns of the container types
+/// supported by SqliteBack (SET_INT, VECTOR_STRING, MAP_INT_DOUBLE, ...) are
+/// stored like BLOB columns, each value serialized with a boost binary
+/// archive.  Conditions can't be applied to container columns.
+///
+/// A footer at the end of each file holds the table's schema and the offset
+/// and row count of every page, the size in bytes of each of its columns
+/// and the minimum and maximum value of each integer column in the page.
+/// Writing a page overwrites the old footer and appends a new one, so that a
+/// file is always readable after a flush.
+/// Queries skip pages whose integer ranges can't satisfy the conditions and
+/// only decode the pages they need, and of those only the requested columns
+/// and the columns with conditions.  QueryColumns and Cursor read directly
+/// from the pages, page by page.
+///
+/// Only values of the types listed above can be recorded, others are
+/// rejected with a ValueError, as are data whose fields don't match the names
+/// and types of their table's columns.  Numbers are written in the byte order
+/// of the machine writing them.
+///
+/// The file of table "MyTable" is "MyTable.cyccol" in the backend's
+/// directory.  If the directory exists, new rows are appended to its tables.
+class ColumnarBack : public FullBackend {
+ public:
+  /// Creates a new backend writing to the directory path, which is created
+  /// if it doesn't exist.
+  ColumnarBack(std::string path);
+
+  /// Writes buffered rows and closes the table files.
+  virtual ~ColumnarBack();
+
+  virtual void Notify(DatumList data);
+
+  virtual std::string Name();
+
+  /// Writes the buffered rows of all tables to disk.
+  virtual void Flush();
+
+  /// Flushes the backend.
+  virtual void Close();
+
+  virtual QueryResult Query(std::string table, std::vector<Cond>* conds);
+
+  /// Decodes the matching rows of each page directly into typed columns.
+  virtual ColumnarResult QueryColumns(std::string table,
+                                      std::vector<Cond>* conds);
+
+  /// Returns a cursor that decodes one page of the table at a time.
+  virtual QueryCursor::Ptr Cursor(std::string table, std::vector<Cond>* conds);
+
+  virtual QueryResult Query(std::string table, std::vector<Cond>* conds,
+                            std::vector<std::string>* cols);
+
+  virtual ColumnarResult QueryColumns(std::string table,
+                                      std::vector<Cond>* conds,
+                                      std::vector<std::string>* cols);
+
+  virtual QueryCursor::Ptr Cursor(std::string table, std::vector<Cond>* conds,
+                                  std::vector<std::string>* cols);
+
+  virtual std::map<std::string, DbTypes> ColumnTypes(std::string table);
+
+  virtual std::list<ColumnInfo> Schema(std::string table);
+
+  virtual std::set<std::string> Tables();
+
+  /// Sets the number of rows buffered per table before they are written as
+  /// a page.
+  void page_rows(int n) { page_rows_ = n; }
+
+  /// Returns the number of rows per page.
+  int page_rows() const { return page_rows_; }
+
+ private:
+  friend class ColumnarCursor;
+
+  /// location, column sizes and integer column ranges of a page
+  struct PageInfo {
+    uint64_t offset;
+    int nrows;
+    std::vector<uint64_t> sizes;
+    std::vector<int> mins;
+    std::vector<int> maxs;
+  };
+
+  /// a table's schema, pages, open file and buffered rows
+  struct Table {
+    std::string name;
+    std::vector<std::string> fields;
+    std::vector<DbTypes> types;
+    std::vector<PageInfo> pages;
+    uint64_t footer_pos;
+    std::fstream* file;
+    ColumnarResult buf;
+  };
+
+  /// Returns the table, opening its file if necessary, or NULL if it doesn't
+  /// exist.
+  Table* GetTable(std::string table);
+
+  /// Creates the table and its file with the fields and types of d.
+  Table* CreateTable(Datum* d);
+
+  /// Returns the table after writing its buffered rows.  Throws an IOError
+  /// if it doesn't exist.
+  Table* ReadTable(std::string table);
+
+  /// Writes the buffered rows of t as a page followed by the new footer.
+  void WritePage(Table* t);
+
+  /// Writes the footer of t at its footer position.
+  void WriteFooter(Table* t);
+
+  /// Reads page p of t into cols (one QueryColumn per field).  Only the
+  /// fields j with decode[j] set are read, the others are left empty.
+  void ReadPage(Table* t, int p, const std::vector<bool>& decode,
+                std::vector<QueryColumn>* cols);
+
+  /// Appends the fields out of the rows of page p of t that satisfy conds to
+  /// rows.
+  void AppendRows(Table* t, int p, const std::vector<Cond>& conds,
+                  const std::vector<int>& out, const std::vector<bool>& decode,
+                  std::vector<QueryRow>* rows);
+
+  /// Returns the indexes of the fields named in cols (all fields if cols is
+  /// NULL) and sets decode to the fields that must be read to return them
+  /// and evaluate conds.  Throws a KeyError for an unknown field.
+  std::vector<int> Columns(Table* t, const std::vector<Cond>& conds,
+                           std::vector<std::string>* cols,
+                           std::vector<bool>* decode);
+
+  /// Returns false if no row of page p of t can satisfy conds.
+  bool PageMayMatch(Table* t, int p, const std::vector<Cond>& conds);
+
+  /// Returns whether each row of cols satisfies conds.
+  std::vector<bool> Matches(Table* t, const std::vector<QueryColumn>& cols,
+                            int nrows, const std::vector<Cond>& conds);
+
+  /// Returns the table's file name.
+  std::string FileName(std::string table);
+
+  std::string path_;
+  int page_rows_;
+  std::map<std::string, Table> tables_;
+};
+
+}  // namespace cyclus
+
+#endif  // CYCLUS_SRC_COLUMNAR_BACK_H_
@@ -3,6 +3,7 @@
 #include <cmath>
 #include <sstream>
 
+#include "comp_vec.h"
 #include "cyc_arithmetic.h"
 #include "error.h"
 #include "pyne.h"
@@ -16,21 +17,11 @@ namespace cyclus {
 namespace compmath {
 
 CompMap Add(const CompMap& v1, const CompMap& v2) {
-  CompMap out(v1);
-  for (CompMap::const_iterator it = v2.begin(); it != v2.end(); ++it) {
-    int nuc = it->first;
-    out[nuc] += it->second;
-  }
-  return out;
+  return CompVec::Add(CompVec(v1), CompVec(v2)).ToCompMap();
 }
 
 CompMap Sub(const CompMap& v1, const CompMap& v2) {
-  CompMap out(v1);
-  for (CompMap::const_iterator it = v2.begin(); it != v2.end(); ++it) {
-    int nuc = it->first;
-    out[nuc] -= it->second;
-  }
-  return out;
+  return CompVec::Sub(CompVec(v1), CompVec(v2)).ToCompMap();
 }
 
 double Sum(const CompMap& v) {
@@ -0,0 +1,144 @@
+#include "comp_vec.h"
+
+#include <algorithm>
+#include <cmath>
+#include <sstream>
+
+#include "cyc_arithmetic.h"
+#include "error.h"
+#include "pyne.h"
+
+namespace cyclus {
+
+CompVec::CompVec(const CompMap& v) {
+  nucs_.reserve(v.size());
+  vals_.reserve(v.size());
+  for (CompMap::const_iterator it = v.begin(); it != v.end(); ++it) {
+    nucs_.push_back(it->first);
+    vals_.push_back(it->second);
+  }
+}
+
+CompMap CompVec::ToCompMap() const {
+  // nuclides are sorted, so every insertion is hinted at the end of the map
+  CompMap v;
+  for (int i = 0; i < nucs_.size(); ++i) {
+    v.insert(v.end(), std::make_pair(nucs_[i], vals_[i]));
+  }
+  return v;
+}
+
+double CompVec::Get(Nuc nuc) const {
+  std::vector<Nuc>::const_iterator it =
+      std::lower_bound(nucs_.begin(), nucs_.end(), nuc);
+  if (it == nucs_.end() || *it != nuc) {
+    return 0;
+  }
+  return vals_[it - nucs_.begin()];
+}
+
+void CompVec::Append(Nuc nuc, double val) {
+  if (!nucs_.empty() && nuc <= nucs_.back()) {
+    std::stringstream ss;
+    ss << "nuclide " << nuc << " can not be appended after nuclide "
+       << nucs_.back() << ".";
+    throw ValueError(ss.str());
+  }
+  nucs_.push_back(nuc);
+  vals_.push_back(val);
+}
+
+double CompVec::Sum() const {
+  return CycArithmetic::KahanSum(vals_);
+}
+
+void CompVec::Scale(double mult) {
+  int n = vals_.size();
+  double* vals = vals_.empty() ? NULL : &vals_[0];
+  for (int i = 0; i < n; ++i) {
+    vals[i] *= mult;
+  }
+}
+
+void CompVec::Normalize(double val) {
+  double sum = Sum();
+  if (sum != val && sum != 0) {
+    Scale(val / sum);
+  }
+}
+
+void CompVec::ApplyThreshold(double threshold) {
+  if (threshold < 0) {
+    std::stringstream ss;
+    ss << "The threshold cannot be negative. The value provided was '"
+       << threshold << "'.";
+    throw ValueError(ss.str());
+  }
+
+  int n = 0;
+  for (int i = 0; i < nucs_.size(); ++i) {
+    if (std::abs(vals_[i]) > threshold) {
+      nucs_[n] = nucs_[i];
+      vals_[n] = vals_[i];
+      ++n;
+    }
+  }
+  nucs_.resize(n);
+  vals_.resize(n);
+}
+
+void CompVec::AtomToMass() {
+  for (int i = 0; i < nucs_.size(); ++i) {
+    vals_[i] *= pyne::atomic_mass(nucs_[i]);
+  }
+}
+
+void CompVec::MassToAtom() {
+  for (int i = 0; i < nucs_.size(); ++i) {
+    vals_[i] /= pyne::atomic_mass(nucs_[i]);
+  }
+}
+
+CompVec CompVec::Add(const CompVec& v1, const CompVec& v2) {
+  return Merge(v1, v2, 1);
+}
+
+CompVec CompVec::Sub(const CompVec& v1, const CompVec& v2) {
+  return Merge(v1, v2, -1);
+}
+
+CompVec CompVec::Merge(const CompVec& v1, const CompVec& v2, double sign) {
+  CompVec out;
+  int n1 = v1.nucs_.size();
+  int n2 = v2.nucs_.size();
+  out.nucs_.reserve(n1 + n2);
+  out.vals_.reserve(n1 + n2);
+
+  int i = 0;
+  int j = 0;
+  while (i < n1 && j < n2) {
+    Nuc nuc1 = v1.nucs_[i];
+    Nuc nuc2 = v2.nucs_[j];
+    if (nuc1 < nuc2) {
+      out.nucs_.push_back(nuc1);
+      out.vals_.push_back(v1.vals_[i++]);
+    } else if (nuc2 < nuc1) {
+      out.nucs_.push_back(nuc2);
+      out.vals_.push_back(sign * v2.vals_[j++]);
+    } else {
+      out.nucs_.push_back(nuc1);
+      out.vals_.push_back(v1.vals_[i++] + sign * v2.vals_[j++]);
+    }
+  }
+  for (; i < n1; ++i) {
+    out.nucs_.push_back(v1.nucs_[i]);
+    out.vals_.push_back(v1.vals_[i]);
+  }
+  for (; j < n2; ++j) {
+    out.nucs_.push_back(v2.nucs_[j]);
+    out.vals_.push_back(sign * v2.vals_[j]);
+  }
+  return out;
+}
+
+}  // namespace cyclus
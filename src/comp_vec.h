@@ -0,0 +1,91 @@
+#ifndef CYCLUS_SRC_COMP_VEC_H_
+#define CYCLUS_SRC_COMP_VEC_H_
+
+#include <vector>
+
+#include "composition.h"
+
+namespace cyclus {
+
+/// A flat nuclide composition. Nuclide ids and their (dimensionless)
+/// quantities are stored in two parallel arrays sorted by nuclide id. A CompVec
+/// holds the same information as a CompMap, but element-wise operations on two
+/// CompVecs are linear merges over contiguous memory instead of tree walks
+/// with a node allocation per nuclide. It is meant for intermediate results
+/// when mixing or splitting compositions:
+///
+/// @code
+/// CompVec v(c0->mass());
+/// v.Normalize(qty0);
+/// CompVec otherv(c1->mass());
+/// otherv.Normalize(qty1);
+/// Composition::Ptr c = Composition::CreateFromMass(
+///     CompVec::Add(v, otherv).ToCompMap());
+/// @endcode
+///
+/// All operations give results identical to their compmath counterparts.
+class CompVec {
+ public:
+  CompVec() {}
+
+  explicit CompVec(const CompMap& v);
+
+  /// Returns the composition as a CompMap.
+  CompMap ToCompMap() const;
+
+  /// the sorted nuclide ids
+  inline const std::vector<Nuc>& nucs() const { return nucs_; }
+
+  /// the quantities corresponding to each of nucs()
+  inline const std::vector<double>& vals() const { return vals_; }
+
+  inline int size() const { return nucs_.size(); }
+
+  inline bool empty() const { return nucs_.empty(); }
+
+  /// Returns the quantity of nuc, or zero if it is not present.
+  double Get(Nuc nuc) const;
+
+  /// Appends a nuclide with a larger id than any already present.
+  /// @throws ValueError if nuc is not larger than the last nuclide
+  void Append(Nuc nuc, double val);
+
+  /// Sums the quantities of all nuclides without normalization.
+  double Sum() const;
+
+  /// Multiplies all quantities by mult.
+  void Scale(double mult);
+
+  /// The sum of quantities of all nuclides is normalized to val.
+  void Normalize(double val = 1.0);
+
+  /// Removes all nuclides with quantities whose magnitude is at or below
+  /// threshold.
+  /// @throws ValueError if threshold is negative
+  void ApplyThreshold(double threshold);
+
+  /// Converts atom quantities to mass quantities in place.
+  void AtomToMass();
+
+  /// Converts mass quantities to atom quantities in place.
+  void MassToAtom();
+
+  /// Does component-wise addition of the nuclide quantities of v1 and v2 and
+  /// returns the result. No normalization is done.
+  static CompVec Add(const CompVec& v1, const CompVec& v2);
+
+  /// Does component-wise subtraction of the nuclide quantities of v1 and v2
+  /// and returns the result. No normalization is done.
+  static CompVec Sub(const CompVec& v1, const CompVec& v2);
+
+ private:
+  /// merges v1 and v2, adding sign times the quantities of v2
+  static CompVec Merge(const CompVec& v1, const CompVec& v2, double sign);
+
+  std::vector<Nuc> nucs_;
+  std::vector<double> vals_;
+};
+
+}  // namespace cyclus
+
+#endif  // CYCLUS_SRC_COMP_VEC_H_
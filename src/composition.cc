@@ -1,8 +1,17 @@
 #include "composition.h"
 
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <list>
+#include <mutex>
+#include <unordered_map>
+
 #include "comp_math.h"
+#include "comp_vec.h"
 #include "context.h"
 #include "decayer.h"
+#include "env.h"
 #include "error.h"
 #include "recorder.h"
 
@@ -12,7 +21,32 @@ extern "C" {
 
 namespace cyclus {
 
-int Composition::next_id_ = 1;
+std::atomic<int> Composition::next_id_(1);
+
+namespace {
+// Guards the lazily computed vectors, recorded flags and decay chains of
+// compositions, which traders may share across threads.
+std::mutex& CompMutex() {
+  static std::mutex m;
+  return m;
+}
+
+// Returns the composition at tot_decay in chain, or NULL.
+Composition::Ptr FindDecay(const std::map<int, Composition::Ptr>& chain,
+                           int tot_decay) {
+  std::lock_guard<std::mutex> lock(CompMutex());
+  std::map<int, Composition::Ptr>::const_iterator it = chain.find(tot_decay);
+  return it == chain.end() ? Composition::Ptr() : it->second;
+}
+
+// Adds c to chain at tot_decay, unless another thread did so first, and
+// returns the composition in the chain.
+Composition::Ptr AddDecay(std::map<int, Composition::Ptr>* chain,
+                          int tot_decay, Composition::Ptr c) {
+  std::lock_guard<std::mutex> lock(CompMutex());
+  return chain->insert(std::make_pair(tot_decay, c)).first->second;
+}
+}  // namespace
 
 Composition::Ptr Composition::CreateFromAtom(CompMap v) {
   if (!compmath::ValidNucs(v))
@@ -22,7 +56,7 @@ Composition::Ptr Composition::CreateFromAtom(CompMap v) {
     throw ValueError("negative quantity in CompMap");
 
   Composition::Ptr c(new Composition());
-  c->atom_ = v;
+  c->atom_.swap(v);
   return c;
 }
 
@@ -34,7 +68,7 @@ Composition::Ptr Composition::CreateFromMass(CompMap v) {
     throw ValueError("negative quantity in CompMap");
 
   Composition::Ptr c(new Composition());
-  c->mass_ = v;
+  c->mass_.swap(v);
   return c;
 }
 
@@ -43,41 +77,39 @@ int Composition::id() {
 }
 
 const CompMap& Composition::atom() {
+  std::lock_guard<std::mutex> lock(CompMutex());
   if (atom_.size() == 0) {
-    CompMap::iterator it;
-    for (it = mass_.begin(); it != mass_.end(); ++it) {
-      Nuc nuc = it->first;
-      atom_[nuc] = it->second / pyne::atomic_mass(nuc);
-    }
+    CompVec v(mass_);
+    v.MassToAtom();
+    atom_ = v.ToCompMap();
   }
   return atom_;
 }
 
 const CompMap& Composition::mass() {
+  std::lock_guard<std::mutex> lock(CompMutex());
   if (mass_.size() == 0) {
-    CompMap::iterator it;
-    for (it = atom_.begin(); it != atom_.end(); ++it) {
-      Nuc nuc = it->first;
-      mass_[nuc] = it->second * pyne::atomic_mass(nuc);
-    }
+    CompVec v(atom_);
+    v.AtomToMass();
+    mass_ = v.ToCompMap();
   }
   return mass_;
 }
 
 Composition::Ptr Composition::Decay(int delta, uint64_t secs_per_timestep) {
   int tot_decay = prev_decay_ + delta;
-  if (decay_line_->count(tot_decay) == 1) {
+  Composition::Ptr decayed = FindDecay(*decay_line_, tot_decay);
+  if (decayed != NULL) {
     // decay_line_ has cached, pre-computed result of this decay
-    return (*decay_line_)[tot_decay];
+    return decayed;
   }
 
   // Calculate a new decayed composition and insert it into the decay chain.
   // It will automagically appear in the decay chain for all other compositions
   // that are a part of this decay chain because decay_line_ is a pointer that
   // all compositions in the chain share.
-  Composition::Ptr decayed = NewDecay(delta, secs_per_timestep);
-  (*decay_line_)[tot_decay] = decayed;
-  return decayed;
+  decayed = NewDecay(delta, secs_per_timestep);
+  return AddDecay(decay_line_.get(), tot_decay, decayed);
 }
 
 Composition::Ptr Composition::Decay(int delta) {
@@ -85,10 +117,13 @@ Composition::Ptr Composition::Decay(int delta) {
 }
 
 void Composition::Record(Context* ctx) {
-  if (recorded_) {
-    return;
+  {
+    std::lock_guard<std::mutex> lock(CompMutex());
+    if (recorded_) {
+      return;
+    }
+    recorded_ = true;
   }
-  recorded_ = true;
 
   CompMap::const_iterator it;
   CompMap cm = mass();  // force lazy evaluation now
@@ -103,8 +138,7 @@ void Composition::Record(Context* ctx) {
 }
 
 Composition::Composition() : prev_decay_(0), recorded_(false) {
-  id_ = next_id_;
-  next_id_++;
+  id_ = next_id_++;
   decay_line_ = ChainPtr(new Chain());
 }
 
@@ -112,11 +146,266 @@ Composition::Composition(int prev_decay, ChainPtr decay_line)
     : recorded_(false),
       prev_decay_(prev_decay),
       decay_line_(decay_line) {
-  id_ = next_id_;
-  next_id_++;
+  id_ = next_id_++;
+}
+
+namespace {
+// Identifies a decay calculation by its decay time and its initial atom
+// vector. Quantities are quantized by dropping the 12 least significant
+// mantissa bits so that compositions differing only by round-off share an
+// entry.
+struct DecayKey {
+  DecayKey(const CompMap& atom, int delta, uint64_t secs_per_timestep)
+      : delta(delta), secs(secs_per_timestep) {
+    nucs.reserve(atom.size());
+    vals.reserve(atom.size());
+    hash = std::hash<int>()(delta) ^ std::hash<uint64_t>()(secs);
+    for (CompMap::const_iterator it = atom.begin(); it != atom.end(); ++it) {
+      uint64_t bits;
+      std::memcpy(&bits, &it->second, sizeof(bits));
+      bits = (bits + (1 << 11)) & ~static_cast<uint64_t>(0xfff);
+      nucs.push_back(it->first);
+      vals.push_back(bits);
+      hash = hash * 31 + std::hash<int>()(it->first);
+      hash = hash * 31 + std::hash<uint64_t>()(bits);
+    }
+  }
+
+  bool operator==(const DecayKey& other) const {
+    return hash == other.hash && delta == other.delta && secs == other.secs &&
+           nucs == other.nucs && vals == other.vals;
+  }
+
+  int delta;
+  uint64_t secs;
+  std::vector<Nuc> nucs;
+  std::vector<uint64_t> vals;
+  size_t hash;
+};
+
+// A least recently used cache of decayed atom vectors shared by all
+// compositions.
+class DecayCache {
+ public:
+  DecayCache() : capacity_(0), hits_(0), misses_(0) {
+    std::string capacity = Env::GetEnv("CYCLUS_DECAY_CACHE");
+    if (capacity.size() > 0) {
+      capacity_ = std::max(0, std::atoi(capacity.c_str()));
+    }
+  }
+
+  // Copies the cached result for key into atom and marks it as most recently
+  // used. Returns false if there is no such result.
+  bool Get(const DecayKey& key, CompMap* atom) {
+    std::lock_guard<std::mutex> lock(mtx_);
+    Entries::iterator it = Find(key);
+    if (it == entries_.end()) {
+      ++misses_;
+      return false;
+    }
+    ++hits_;
+    entries_.splice(entries_.begin(), entries_, it);
+    *atom = it->second;
+    return true;
+  }
+
+  void Put(const DecayKey& key, const CompMap& atom) {
+    std::lock_guard<std::mutex> lock(mtx_);
+    if (capacity_ == 0 || Find(key) != entries_.end()) {
+      return;
+    }
+    entries_.push_front(std::make_pair(key, atom));
+    index_.insert(std::make_pair(key.hash, entries_.begin()));
+    Shrink();
+  }
+
+  void capacity(int n) {
+    std::lock_guard<std::mutex> lock(mtx_);
+    capacity_ = std::max(0, n);
+    Shrink();
+  }
+
+  int capacity() {
+    std::lock_guard<std::mutex> lock(mtx_);
+    return capacity_;
+  }
+
+  uint64_t hits() {
+    std::lock_guard<std::mutex> lock(mtx_);
+    return hits_;
+  }
+
+  uint64_t misses() {
+    std::lock_guard<std::mutex> lock(mtx_);
+    return misses_;
+  }
+
+  void Clear() {
+    std::lock_guard<std::mutex> lock(mtx_);
+    entries_.clear();
+    index_.clear();
+    hits_ = 0;
+    misses_ = 0;
+  }
+
+ private:
+  // most recently used first
+  typedef std::list<std::pair<DecayKey, CompMap> > Entries;
+  typedef std::unordered_multimap<size_t, Entries::iterator> Index;
+
+  Entries::iterator Find(const DecayKey& key) {
+    std::pair<Index::iterator, Index::iterator> range =
+        index_.equal_range(key.hash);
+    for (Index::iterator it = range.first; it != range.second; ++it) {
+      if (it->second->first == key) {
+        return it->second;
+      }
+    }
+    return entries_.end();
+  }
+
+  // evicts least recently used entries until the cache is within capacity
+  void Shrink() {
+    while (entries_.size() > static_cast<size_t>(capacity_)) {
+      Entries::iterator last = --entries_.end();
+      std::pair<Index::iterator, Index::iterator> range =
+          index_.equal_range(last->first.hash);
+      for (Index::iterator it = range.first; it != range.second; ++it) {
+        if (it->second == last) {
+          index_.erase(it);
+          break;
+        }
+      }
+      entries_.erase(last);
+    }
+  }
+
+  int capacity_;
+  uint64_t hits_;
+  uint64_t misses_;
+  Entries entries_;
+  Index index_;
+  std::mutex mtx_;
+};
+
+DecayCache& GlobalDecayCache() {
+  static DecayCache cache;
+  return cache;
+}
+
+// Returns the CRAM decay matrix scaled for a decay time of t seconds.
+std::vector<double> DecayMatrix(double t) {
+  std::vector<double> decay_matrix(pyne_cram_transmute_info.nnz);
+  for (int i = 0; i < pyne_cram_transmute_info.nnz; ++i) {
+    decay_matrix[i] = -pyne_cram_transmute_info.decay_matrix[i] * t;
+  }
+  return decay_matrix;
+}
+}  // namespace
+
+std::vector<Composition::Ptr> Composition::DecayMany(
+    const std::vector<Ptr>& comps, int delta, uint64_t secs_per_timestep) {
+  std::vector<Ptr> decayed(comps.size());
+  std::vector<double> decay_matrix;
+  std::vector<double> n0;
+  std::vector<double> n1;
+  for (int i = 0; i < comps.size(); ++i) {
+    Composition* c = comps[i].get();
+    int tot_decay = c->prev_decay_ + delta;
+    decayed[i] = FindDecay(*c->decay_line_, tot_decay);
+    if (decayed[i] != NULL) {
+      // cached by an earlier call or by an earlier member of this batch
+      continue;
+    }
+
+    decayed[i] = c->CachedDecay(delta, secs_per_timestep);
+    if (decayed[i] != NULL) {
+      decayed[i] = AddDecay(c->decay_line_.get(), tot_decay, decayed[i]);
+      continue;
+    }
+
+    if (decay_matrix.empty()) {
+      double t = static_cast<double>(secs_per_timestep) * delta;
+      decay_matrix = DecayMatrix(t);
+      n0.resize(pyne_cram_transmute_info.n);
+      n1.resize(pyne_cram_transmute_info.n);
+    }
+    decayed[i] = c->NewDecay(delta, decay_matrix, n0, n1);
+    c->CacheDecay(delta, secs_per_timestep, decayed[i]);
+    decayed[i] = AddDecay(c->decay_line_.get(), tot_decay, decayed[i]);
+  }
+  return decayed;
+}
+
+std::vector<Composition::Ptr> Composition::DecayMany(
+    const std::vector<Ptr>& comps, int delta) {
+  return DecayMany(comps, delta, kDefaultTimeStepDur);
 }
 
 Composition::Ptr Composition::NewDecay(int delta, uint64_t secs_per_timestep) {
+  Composition::Ptr decayed = CachedDecay(delta, secs_per_timestep);
+  if (decayed != NULL) {
+    return decayed;
+  }
+
+  double t = static_cast<double>(secs_per_timestep) * delta;
+  std::vector<double> decay_matrix = DecayMatrix(t);
+  std::vector<double> n0(pyne_cram_transmute_info.n);
+  std::vector<double> n1(pyne_cram_transmute_info.n);
+  decayed = NewDecay(delta, decay_matrix, n0, n1);
+  CacheDecay(delta, secs_per_timestep, decayed);
+  return decayed;
+}
+
+void Composition::decay_cache_capacity(int n) {
+  GlobalDecayCache().capacity(n);
+}
+
+int Composition::decay_cache_capacity() {
+  return GlobalDecayCache().capacity();
+}
+
+uint64_t Composition::decay_cache_hits() {
+  return GlobalDecayCache().hits();
+}
+
+uint64_t Composition::decay_cache_misses() {
+  return GlobalDecayCache().misses();
+}
+
+void Composition::ClearDecayCache() {
+  GlobalDecayCache().Clear();
+}
+
+Composition::Ptr Composition::CachedDecay(int delta,
+                                          uint64_t secs_per_timestep) {
+  DecayCache& cache = GlobalDecayCache();
+  if (cache.capacity() == 0) {
+    return Ptr();
+  }
+
+  CompMap cm;
+  if (!cache.Get(DecayKey(atom(), delta, secs_per_timestep), &cm)) {
+    return Ptr();
+  }
+  Composition::Ptr decayed(new Composition(prev_decay_ + delta, decay_line_));
+  decayed->atom_.swap(cm);
+  return decayed;
+}
+
+void Composition::CacheDecay(int delta, uint64_t secs_per_timestep,
+                             Composition::Ptr decayed) {
+  DecayCache& cache = GlobalDecayCache();
+  if (cache.capacity() == 0) {
+    return;
+  }
+  cache.Put(DecayKey(atom(), delta, secs_per_timestep), decayed->atom_);
+}
+
+Composition::Ptr Composition::NewDecay(int delta,
+                                       std::vector<double>& decay_matrix,
+                                       std::vector<double>& n0,
+                                       std::vector<double>& n1) {
   int tot_decay = prev_decay_ + delta;
   atom();  // force evaluation of atom-composition if not calculated already
 
@@ -129,7 +418,7 @@ Composition::Ptr Composition::NewDecay(int delta, uint64_t secs_per_timestep) {
     return decayed;
 
   // Get intial condition vector
-  std::vector<double> n0 (pyne_cram_transmute_info.n, 0.0);
+  std::fill(n0.begin(), n0.end(), 0.0);
   CompMap::const_iterator it;
   int i = -1;
   for (it = atom_.begin(); it != atom_.end(); ++it) {
@@ -140,15 +429,7 @@ Composition::Ptr Composition::NewDecay(int delta, uint64_t secs_per_timestep) {
     n0[i] = it->second;
   }
 
-  // get decay matrix
-  double t = static_cast<double>(secs_per_timestep) * delta;
-  std::vector<double> decay_matrix (pyne_cram_transmute_info.nnz);
-  for (i=0; i < pyne_cram_transmute_info.nnz; ++i) {
-    decay_matrix[i] = -pyne_cram_transmute_info.decay_matrix[i] * t;
-  }
-
   // perform decay
-  std::vector<double> n1 (pyne_cram_transmute_info.n);
   pyne_cram_expm_multiply14(decay_matrix.data(), n0.data(), n1.data());
 
   // convert back to map
@@ -158,7 +439,7 @@ Composition::Ptr Composition::NewDecay(int delta, uint64_t secs_per_timestep) {
       cm[(pyne_cram_transmute_info.nucids)[i]] = n1[i];
     }
   }
-  decayed->atom_ = cm;
+  decayed->atom_.swap(cm);
   return decayed;
 }
 
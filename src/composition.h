@@ -1,7 +1,9 @@
 #ifndef CYCLUS_SRC_COMPOSITION_H_
 #define CYCLUS_SRC_COMPOSITION_H_
 
+#include <atomic>
 #include <map>
+#include <vector>
 #include <stdint.h>
 #include <boost/shared_ptr.hpp>
 
@@ -73,10 +75,45 @@ class Composition {
   /// delta timesteps) using the seconds to timestep conversion specified.
   Ptr Decay(int delta, uint64_t secs_per_timestep);
 
+  /// Returns decayed versions of all comps (each decayed delta timesteps), in
+  /// the same order, assuming a time step is 1/12 of one year in duration. The
+  /// result is the same as calling Decay on each composition, but the decay
+  /// matrix is scaled once for the whole batch and compositions of the same
+  /// decay chain that reach the same total decay are calculated only once.
+  static std::vector<Ptr> DecayMany(const std::vector<Ptr>& comps, int delta);
+
+  /// Returns decayed versions of all comps (each decayed delta timesteps), in
+  /// the same order, using the seconds to timestep conversion specified.
+  static std::vector<Ptr> DecayMany(const std::vector<Ptr>& comps, int delta,
+                                    uint64_t secs_per_timestep);
+
   /// Records the composition in output database Compositions table (if
   /// not done previously).
   void Record(Context* ctx);
 
+  /// Sets the maximum number of results kept in the process-wide decay cache.
+  /// Unlike a decay chain, the cache is shared by all compositions: decaying a
+  /// composition whose atom vector matches (to about 12 significant digits)
+  /// that of a previously decayed, unrelated composition reuses the earlier
+  /// result if delta and the time step duration are the same. The least
+  /// recently used results are evicted first. A capacity of zero disables the
+  /// cache. The initial capacity is read from the CYCLUS_DECAY_CACHE
+  /// environment variable and is zero if it is not set.
+  static void decay_cache_capacity(int n);
+
+  /// Returns the maximum number of results kept in the decay cache.
+  static int decay_cache_capacity();
+
+  /// Returns the number of decay calculations answered by the decay cache.
+  static uint64_t decay_cache_hits();
+
+  /// Returns the number of decay calculations performed while the decay cache
+  /// was enabled because no matching result was cached.
+  static uint64_t decay_cache_misses();
+
+  /// Empties the decay cache and resets its hit and miss counters.
+  static void ClearDecayCache();
+
  protected:
   /// a chain containing compositions that are a result of decay from a common
   /// ancestor composition. The key is the total amount of time a composition
@@ -97,7 +134,21 @@ class Composition {
   /// Performs a decay calculation and creates a new decayed composition.
   Ptr NewDecay(int delta, uint64_t secs_per_timestep);
 
-  static int next_id_;
+  /// Performs a decay calculation with a decay matrix already scaled by the
+  /// decay time and creates a new decayed composition. n0 and n1 are scratch
+  /// space of the size of the CRAM system.
+  Ptr NewDecay(int delta, std::vector<double>& decay_matrix,
+               std::vector<double>& n0, std::vector<double>& n1);
+
+  /// Returns the result of decaying this composition delta timesteps from the
+  /// process-wide decay cache, or NULL if it is disabled or has no match.
+  Ptr CachedDecay(int delta, uint64_t secs_per_timestep);
+
+  /// Stores decayed in the process-wide decay cache (if enabled) as the result
+  /// of decaying this composition delta timesteps.
+  void CacheDecay(int delta, uint64_t secs_per_timestep, Ptr decayed);
+
+  static std::atomic<int> next_id_;
   int id_;
   bool recorded_;
   CompMap atom_;
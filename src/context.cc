@@ -25,6 +25,7 @@ SimInfo::SimInfo()
       branch_time(-1),
       explicit_inventory(false),
       explicit_inventory_compact(false),
+      incremental_snapshot(false),
       parent_sim(boost::uuids::nil_uuid()),
       parent_type("init") {}
 
@@ -38,6 +39,7 @@ SimInfo::SimInfo(int dur, int y0, int m0, std::string handle)
       handle(handle),
       explicit_inventory(false),
       explicit_inventory_compact(false),
+      incremental_snapshot(false),
       parent_sim(boost::uuids::nil_uuid()),
       parent_type("init") {}
 
@@ -51,6 +53,7 @@ SimInfo::SimInfo(int dur, int y0, int m0, std::string handle, std::string d)
       handle(handle),
       explicit_inventory(false),
       explicit_inventory_compact(false),
+      incremental_snapshot(false),
       parent_sim(boost::uuids::nil_uuid()),
       parent_type("init") {}
 
@@ -67,6 +70,7 @@ SimInfo::SimInfo(int dur, boost::uuids::uuid parent_sim,
       branch_time(branch_time),
       explicit_inventory(false),
       explicit_inventory_compact(false),
+      incremental_snapshot(false),
       handle(handle) {}
 
 Context::Context(Timer* ti, Recorder* rec)
@@ -98,6 +102,7 @@ Context::~Context() {
 void Context::DelAgent(Agent* m) {
   int n = agent_list_.erase(m);
   if (n == 1) {
+    snapshot_digests_.erase(m->id());
     PyDelAgent(m->id());
     delete m;
     m = NULL;
@@ -205,6 +210,10 @@ void Context::InitSim(SimInfo si) {
       ->AddVal("RecordInventoryCompact", si.explicit_inventory_compact)
       ->Record();
 
+  NewDatum("InfoSnapshot")
+      ->AddVal("Incremental", si.incremental_snapshot)
+      ->Record();
+
   // TODO: when the backends get uint64_t support, the static_cast here should
   // be removed.
   NewDatum("TimeStepDur")
@@ -114,6 +114,10 @@ class SimInfo {
   /// every time step in a table (i.e. agent ID, Time, Quantity,
   /// Composition-object and/or reference).
   bool explicit_inventory_compact;
+
+  /// True if snapshots should only record the state of agents that changed
+  /// since their previous snapshot.
+  bool incremental_snapshot;
 };
 
 /// A simulation context provides access to necessary simulation-global
@@ -307,6 +311,10 @@ class Context {
   std::map<std::string, int> n_prototypes_;
   std::map<std::string, int> n_specs_;
 
+  /// digests of the state recorded by each agent's latest incremental
+  /// snapshot, keyed by agent id
+  std::map<int, Digest> snapshot_digests_;
+
   SimInfo si_;
   Timer* ti_;
   ExchangeSolver* solver_;
@@ -8,9 +8,12 @@ namespace cyclus {
 typedef boost::singleton_pool<Datum, sizeof(Datum)> DatumPool;
 
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
-Datum* Datum::AddValBase(const char* field, boost::spirit::hold_any val,
+Datum* Datum::AddValBase(const char* field, boost::spirit::hold_any& val,
                          std::vector<int>* shape) {
-  vals_.push_back(std::pair<const char*, boost::spirit::hold_any>(field, val));
+  // hold_any has no move semantics, so an empty entry is appended and the
+  // value swapped into it rather than deep copying it again.
+  vals_.push_back(Entry(field, boost::spirit::hold_any()));
+  vals_.back().second.swap(val);
   std::vector<int> s;
   if (shape == NULL)
     shapes_.push_back(s);
@@ -49,7 +52,7 @@ Datum::Datum(Recorder* m, std::string title) : title_(title), manager_(m) {
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 Datum::~Datum() {}
 
-std::string Datum::title() {
+const std::string& Datum::title() {
   return title_;
 }
 
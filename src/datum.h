@@ -57,7 +57,7 @@ class Datum {
   void Record();
 
   /// Returns the datum's title as specified during the datum's creation.
-  std::string title();
+  const std::string& title();
 
   /// Returns a vector of all field-value pairs that have been added to this datum.
   const Vals& vals();
@@ -76,7 +76,7 @@ class Datum {
   /// Datum objects should generally not be created using a constructor (i.e.
   /// use the recorder interface).
   Datum(Recorder* m, std::string title);
-  Datum* AddValBase(const char* field, boost::spirit::hold_any val,
+  Datum* AddValBase(const char* field, boost::spirit::hold_any& val,
                     std::vector<int>* shape = NULL);
 
   Recorder* manager_;
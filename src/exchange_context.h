@@ -28,6 +28,31 @@ struct PrefMap {
   typedef Bid<T>* bid_ptr;
 };
 
+/// @brief A flat view of a PrefMap, listing the request, bid, and a pointer to
+/// the preference of each request-bid pair in the map's order. Adjusting
+/// preferences through the view avoids walking the nested maps. The view is
+/// valid as long as no pairs are added to or removed from the map.
+template <class T>
+struct PrefView {
+  explicit PrefView(typename PrefMap<T>::type& map) {
+    typename PrefMap<T>::type::iterator r;
+    typename std::map<Bid<T>*, double>::iterator b;
+    for (r = map.begin(); r != map.end(); ++r) {
+      for (b = r->second.begin(); b != r->second.end(); ++b) {
+        requests.push_back(r->first);
+        bids.push_back(b->first);
+        prefs.push_back(&b->second);
+      }
+    }
+  }
+
+  inline int size() const { return prefs.size(); }
+
+  std::vector<Request<T>*> requests;
+  std::vector<Bid<T>*> bids;
+  std::vector<double*> prefs;
+};
+
 template <class T>
 struct CommodMap {
   typedef std::map<std::string, std::vector<Request<T>*> > type;
@@ -15,6 +15,7 @@ ExchangeNode::ExchangeNode(double qty, bool exclusive, std::string commod,
       exclusive(exclusive),
       commod(commod),
       agent_id(agent_id),
+      multiplicity(1),
       group(NULL) {}
 
 ExchangeNode::ExchangeNode(double qty, bool exclusive)
@@ -22,6 +23,7 @@ ExchangeNode::ExchangeNode(double qty, bool exclusive)
       exclusive(exclusive),
       commod(""),
       agent_id(-1),
+      multiplicity(1),
       group(NULL) {}
 
 ExchangeNode::ExchangeNode(double qty, bool exclusive, std::string commod)
@@ -29,6 +31,7 @@ ExchangeNode::ExchangeNode(double qty, bool exclusive, std::string commod)
       exclusive(exclusive),
       commod(commod),
       agent_id(-1),
+      multiplicity(1),
       group(NULL) {}
 
 ExchangeNode::ExchangeNode(double qty)
@@ -36,6 +39,7 @@ ExchangeNode::ExchangeNode(double qty)
       exclusive(false),
       commod(""),
       agent_id(-1),
+      multiplicity(1),
       group(NULL) {}
 
 ExchangeNode::ExchangeNode()
@@ -43,6 +47,7 @@ ExchangeNode::ExchangeNode()
       exclusive(false),
       commod(""),
       agent_id(-1),
+      multiplicity(1),
       group(NULL) {}
 
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
@@ -51,7 +56,8 @@ bool operator==(const ExchangeNode& lhs, const ExchangeNode& rhs) {
           lhs.qty == rhs.qty &&
           lhs.exclusive == rhs.exclusive &&
           lhs.group == rhs.group &&
-          lhs.commod == rhs.commod);
+          lhs.commod == rhs.commod &&
+          lhs.multiplicity == rhs.multiplicity);
 }
 
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
@@ -68,13 +74,17 @@ Arc::Arc(boost::shared_ptr<ExchangeNode> unode,
     double dist = boost::math::float_distance(fqty, sqty);
     if (unode->exclusive && vnode->exclusive) {
       excl_val_ = (std::abs(dist) <= float_ulp_eq) ? fqty : 0;
+      excl_units_ = std::min(unode->multiplicity, vnode->multiplicity);
     } else if (unode->exclusive) {
       excl_val_ = dist >= -float_ulp_eq ? fqty : 0;
+      excl_units_ = unode->multiplicity;
     } else {
       excl_val_ = dist <= float_ulp_eq ? sqty : 0;
+      excl_units_ = vnode->multiplicity;
     }
   } else {
     excl_val_ = 0;
+    excl_units_ = 0;
   }
 }
 
@@ -84,7 +94,8 @@ Arc::Arc(const Arc& other)
       vnode_(other.vnode()),
       pref_(other.pref()),
       exclusive_(other.exclusive()),
-      excl_val_(other.excl_val()) {}
+      excl_val_(other.excl_val()),
+      excl_units_(other.excl_units()) {}
 
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 void ExchangeNodeGroup::AddExchangeNode(ExchangeNode::Ptr node) {
@@ -92,6 +103,17 @@ void ExchangeNodeGroup::AddExchangeNode(ExchangeNode::Ptr node) {
   nodes_.push_back(node);
 }
 
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+void ExchangeNodeGroup::AddExclGroup(std::vector<ExchangeNode::Ptr>& nodes) {
+  for (int i = 1; i < nodes.size(); ++i) {
+    if (nodes[i]->multiplicity != nodes[0]->multiplicity) {
+      throw ValueError("exclusive bids on the same offer must have the same"
+                       " multiplicity");
+    }
+  }
+  excl_node_groups_.push_back(nodes);
+}
+
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 void ExchangeNodeGroup::AddExclNode(ExchangeNode::Ptr node) {
   std::vector<ExchangeNode::Ptr> nodes;
@@ -111,7 +133,7 @@ void RequestGroup::AddExchangeNode(ExchangeNode::Ptr node) {
 }
 
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
-ExchangeGraph::ExchangeGraph() : next_arc_id_(0) { }
+ExchangeGraph::ExchangeGraph() : n_mapped_(0) { }
 
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 void ExchangeGraph::AddRequestGroup(RequestGroup::Ptr prs) {
@@ -126,11 +148,17 @@ void ExchangeGraph::AddSupplyGroup(ExchangeNodeGroup::Ptr pss) {
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 void ExchangeGraph::AddArc(const Arc& a) {
   arcs_.push_back(a);    
-  int id = next_arc_id_++;
-  arc_ids_.insert(std::pair<Arc, int>(a, id));
-  arc_by_id_.insert(std::pair<int, Arc>(id, a));
-  node_arc_map_[a.unode()].push_back(a);
-  node_arc_map_[a.vnode()].push_back(a);
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+void ExchangeGraph::BuildMaps() const {
+  for (; n_mapped_ < arcs_.size(); ++n_mapped_) {
+    const Arc& a = arcs_[n_mapped_];
+    arc_ids_.insert(std::pair<Arc, int>(a, n_mapped_));
+    arc_by_id_.insert(std::pair<int, Arc>(n_mapped_, a));
+    node_arc_map_[a.unode()].push_back(a);
+    node_arc_map_[a.vnode()].push_back(a);
+  }
 }
 
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
@@ -138,4 +166,156 @@ void ExchangeGraph::AddMatch(const Arc& a, double qty) {
   matches_.push_back(std::make_pair(a, qty));
 }
 
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+namespace {
+int FindRoot(std::vector<int>& parents, int i) {
+  while (parents[i] != i) {
+    parents[i] = parents[parents[i]];  // path halving
+    i = parents[i];
+  }
+  return i;
+}
+}  // namespace
+
+std::vector<ExchangeGraph::Ptr> ExchangeGraph::ConnectedComponents() const {
+  // request groups are indexed first, followed by supply groups
+  int nreq = request_groups_.size();
+  int ngrps = nreq + supply_groups_.size();
+  std::map<ExchangeNodeGroup*, int> idx;
+  for (int i = 0; i < nreq; ++i) {
+    idx[request_groups_[i].get()] = i;
+  }
+  for (int i = nreq; i < ngrps; ++i) {
+    idx[supply_groups_[i - nreq].get()] = i;
+  }
+
+  // union the groups on either end of each arc
+  std::vector<int> parents(ngrps);
+  std::vector<bool> has_arcs(ngrps, false);
+  std::vector<std::pair<int, int> > ends(arcs_.size());
+  for (int i = 0; i < ngrps; ++i) {
+    parents[i] = i;
+  }
+  for (int i = 0; i < arcs_.size(); ++i) {
+    std::map<ExchangeNodeGroup*, int>::const_iterator u, v;
+    u = idx.find(arcs_[i].unode()->group);
+    v = idx.find(arcs_[i].vnode()->group);
+    if (u == idx.end() || v == idx.end()) {
+      throw StateError("An arc's nodes must belong to the graph's groups.");
+    }
+    ends[i] = std::make_pair(u->second, v->second);
+    has_arcs[u->second] = true;
+    has_arcs[v->second] = true;
+    int uroot = FindRoot(parents, u->second);
+    int vroot = FindRoot(parents, v->second);
+    if (uroot != vroot) {
+      parents[std::max(uroot, vroot)] = std::min(uroot, vroot);
+    }
+  }
+
+  // every component's root is its lowest index, i.e., its first request group
+  std::vector<ExchangeGraph::Ptr> comps;
+  std::map<int, ExchangeGraph*> by_root;
+  for (int i = 0; i < ngrps; ++i) {
+    if (!has_arcs[i]) {
+      continue;
+    }
+    int root = FindRoot(parents, i);
+    if (by_root.count(root) == 0) {
+      comps.push_back(ExchangeGraph::Ptr(new ExchangeGraph()));
+      by_root[root] = comps.back().get();
+    }
+    if (i < nreq) {
+      by_root[root]->AddRequestGroup(request_groups_[i]);
+    } else {
+      by_root[root]->AddSupplyGroup(supply_groups_[i - nreq]);
+    }
+  }
+  for (int i = 0; i < arcs_.size(); ++i) {
+    by_root[FindRoot(parents, ends[i].first)]->AddArc(arcs_[i]);
+  }
+  return comps;
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+namespace {
+void AppendUnitCaps(const ExchangeNode& n, const Arc& a,
+                    std::vector<double>* ucaps, std::vector<int>* starts) {
+  std::map<Arc, std::vector<double> >::const_iterator it =
+      n.unit_capacities.find(a);
+  if (it != n.unit_capacities.end()) {
+    ucaps->insert(ucaps->end(), it->second.begin(), it->second.end());
+  }
+  starts->push_back(ucaps->size());
+}
+}  // namespace
+
+FlatExchangeGraph::FlatExchangeGraph(const ExchangeGraph& g)
+    : nreq(g.request_groups().size()) {
+  for (int i = 0; i < nreq; ++i) {
+    groups.push_back(g.request_groups()[i].get());
+  }
+  for (int i = 0; i < g.supply_groups().size(); ++i) {
+    groups.push_back(g.supply_groups()[i].get());
+  }
+
+  group_start.push_back(0);
+  cap_start.push_back(0);
+  for (int i = 0; i < groups.size(); ++i) {
+    const std::vector<ExchangeNode::Ptr>& grp_nodes = groups[i]->nodes();
+    for (int j = 0; j < grp_nodes.size(); ++j) {
+      node_index.push_back(std::make_pair(grp_nodes[j].get(), nodes.size()));
+      nodes.push_back(grp_nodes[j].get());
+      node_group.push_back(i);
+    }
+    group_start.push_back(nodes.size());
+    const std::vector<double>& grp_caps = groups[i]->capacities();
+    caps.insert(caps.end(), grp_caps.begin(), grp_caps.end());
+    cap_start.push_back(caps.size());
+  }
+  std::sort(node_index.begin(), node_index.end());
+
+  const std::vector<Arc>& arcs = g.arcs();
+  int narcs = arcs.size();
+  arc_u.resize(narcs);
+  arc_v.resize(narcs);
+  u_pref.resize(narcs);
+  ucap_start.push_back(0);
+  adj_start.assign(nodes.size() + 1, 0);
+  for (int i = 0; i < narcs; ++i) {
+    ExchangeNode::Ptr u = arcs[i].unode();
+    ExchangeNode::Ptr v = arcs[i].vnode();
+    arc_u[i] = NodeId(u.get());
+    arc_v[i] = NodeId(v.get());
+    if (arc_u[i] < 0 || arc_v[i] < 0) {
+      throw StateError("An arc's nodes must belong to the graph's groups.");
+    }
+    std::map<Arc, double>::const_iterator pref = u->prefs.find(arcs[i]);
+    u_pref[i] = pref != u->prefs.end() ? pref->second : 0;
+    AppendUnitCaps(*u, arcs[i], &ucaps_data, &ucap_start);
+    AppendUnitCaps(*v, arcs[i], &ucaps_data, &ucap_start);
+    ++adj_start[arc_u[i] + 1];
+    ++adj_start[arc_v[i] + 1];
+  }
+
+  // each arc is listed by both of its nodes, in the order of the arcs
+  for (int i = 0; i < nodes.size(); ++i) {
+    adj_start[i + 1] += adj_start[i];
+  }
+  std::vector<int> next(adj_start.begin(), adj_start.end() - 1);
+  adj_arcs.resize(2 * narcs);
+  for (int i = 0; i < narcs; ++i) {
+    adj_arcs[next[arc_u[i]]++] = i;
+    adj_arcs[next[arc_v[i]]++] = i;
+  }
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+int FlatExchangeGraph::NodeId(const ExchangeNode* n) const {
+  std::vector<std::pair<const ExchangeNode*, int> >::const_iterator it =
+      std::lower_bound(node_index.begin(), node_index.end(),
+                       std::make_pair(n, -1));
+  return (it != node_index.end() && it->first == n) ? it->second : -1;
+}
+
 }  // namespace cyclus
@@ -23,7 +23,9 @@ class Arc;
 /// capacity of ExchangeNodeGroup. ExchangeNodes also have a notion of quantity,
 /// i.e., the maximum amount of a resource that can be attributed to
 /// it. Finally, nodes can be exclusive, that is to say that they represent a
-/// request or bid that must be exclusively satisfied (it can not be split).
+/// request or bid that must be exclusively satisfied (it can not be split). An
+/// exclusive node may stand for several identical exclusive units (see
+/// multiplicity), each of which can be matched separately.
 struct ExchangeNode {
  public:
   typedef boost::shared_ptr<ExchangeNode> Ptr;
@@ -55,8 +57,12 @@ struct ExchangeNode {
   int agent_id;
 
   /// @brief the maximum amount of a resource that can be associated with this
-  /// node
+  /// node, or with one of its units if it has more than one
   double qty;
+
+  /// @brief the number of identical exclusive units of qty this node stands
+  /// for (one for non-exclusive nodes)
+  int multiplicity;
 };
 
 /// @brief An arc represents a possible connection between two nodes in the
@@ -80,6 +86,7 @@ class Arc {
     vnode_ = other.vnode();
     exclusive_ = other.exclusive();
     excl_val_ = other.excl_val();
+    excl_units_ = other.excl_units();
     return *this;
   }
 
@@ -96,6 +103,11 @@ class Arc {
   inline boost::shared_ptr<ExchangeNode> vnode() const { return vnode_.lock(); }
   inline bool exclusive() const { return exclusive_; }
   inline double excl_val() const { return excl_val_; }
+
+  /// @brief the maximum number of exclusive units of excl_val() that can flow
+  /// over an exclusive arc, i.e., the multiplicity of its exclusive node (the
+  /// smaller one if both are exclusive)
+  inline int excl_units() const { return excl_units_; }
   inline double pref() const { return pref_; }
   inline void pref(double pref) { pref_ = pref; }
   
@@ -104,6 +116,7 @@ class Arc {
   boost::weak_ptr<ExchangeNode> vnode_;
   bool exclusive_;
   double excl_val_, pref_;
+  int excl_units_;
 };
 
 /// @brief ExchangeNode-ExchangeNode equality operator
@@ -144,10 +157,9 @@ class ExchangeNodeGroup {
   /// general this function is used for bid exclusivity. An exclusive group
   /// implies that for all nodes in that group, flow is only allowed to flow
   /// over one. This is the case for multiple bids that refer to the same
-  /// exclusive object.
-  inline void AddExclGroup(std::vector<ExchangeNode::Ptr>& nodes) {
-    excl_node_groups_.push_back(nodes);
-  }
+  /// exclusive object. The nodes share that object's units, so they must all
+  /// have the same multiplicity, otherwise a ValueError is thrown.
+  void AddExclGroup(std::vector<ExchangeNode::Ptr>& nodes);
 
   /// @return true of any nodes have arcs associated with them
   bool HasArcs() {
@@ -227,6 +239,15 @@ class ExchangeGraph {
 
   /// clears all matches
   inline void ClearMatches() { matches_.clear(); }
+
+  /// @brief splits the graph into its connected components. Request and supply
+  /// groups are connected if an arc joins any of their nodes; groups share
+  /// capacities, so a group is never split between components. Each component
+  /// is returned as a new graph sharing the groups, nodes, and arcs of this
+  /// graph, with arcs in their original order. Groups without arcs can not be
+  /// matched and are left out. Components are ordered by their first request
+  /// group.
+  std::vector<ExchangeGraph::Ptr> ConnectedComponents() const;
   
   inline const std::vector<RequestGroup::Ptr>& request_groups() const {
     return request_groups_;
@@ -242,34 +263,118 @@ class ExchangeGraph {
     return supply_groups_;
   }
 
+  /// @brief the arcs of each node, in the order they were added. This map,
+  /// arc_ids(), and arc_by_id() are views of arcs() that are built on first
+  /// use after arcs are added; solvers should prefer a FlatExchangeGraph.
   inline const std::map<ExchangeNode::Ptr, std::vector<Arc> >&
       node_arc_map() const {
+    BuildMaps();
     return node_arc_map_;
   }
   inline std::map<ExchangeNode::Ptr, std::vector<Arc> >& node_arc_map() {
+    BuildMaps();
     return node_arc_map_;
   }
 
   inline const std::vector<Match>& matches() { return matches_; }
 
+  /// @brief the graph's arcs, the id of an arc is its index
   inline const std::vector<Arc>& arcs() const { return arcs_; }
   inline std::vector<Arc>& arcs() { return arcs_; }
 
-  inline const std::map<Arc, int>& arc_ids() const { return arc_ids_; }
-  inline std::map<Arc, int>& arc_ids() { return arc_ids_; }
+  inline const std::map<Arc, int>& arc_ids() const {
+    BuildMaps();
+    return arc_ids_;
+  }
+  inline std::map<Arc, int>& arc_ids() {
+    BuildMaps();
+    return arc_ids_;
+  }
 
-  inline const std::map<int, Arc>& arc_by_id() const { return arc_by_id_; }
-  inline std::map<int, Arc>& arc_by_id() { return arc_by_id_; }
+  inline const std::map<int, Arc>& arc_by_id() const {
+    BuildMaps();
+    return arc_by_id_;
+  }
+  inline std::map<int, Arc>& arc_by_id() {
+    BuildMaps();
+    return arc_by_id_;
+  }
   
  private:
+  /// @brief adds the arcs added since the last call to the arc maps
+  void BuildMaps() const;
+
   std::vector<RequestGroup::Ptr> request_groups_;
   std::vector<ExchangeNodeGroup::Ptr> supply_groups_;
-  std::map<ExchangeNode::Ptr, std::vector<Arc> > node_arc_map_;
   std::vector<Match> matches_;
   std::vector<Arc> arcs_;
-  std::map<Arc, int> arc_ids_;
-  std::map<int, Arc> arc_by_id_;
-  int next_arc_id_;
+  mutable std::map<ExchangeNode::Ptr, std::vector<Arc> > node_arc_map_;
+  mutable std::map<Arc, int> arc_ids_;
+  mutable std::map<int, Arc> arc_by_id_;
+  mutable int n_mapped_;
+};
+
+/// @class FlatExchangeGraph
+///
+/// @brief A compact, index-based snapshot of an ExchangeGraph for solvers.
+/// Groups are numbered with request groups first, followed by supply groups,
+/// nodes in the order of their groups, and arcs by their ids in the graph.
+/// Adjacency, preferences, and capacities are kept in contiguous arrays, so
+/// that solvers can look them up by index instead of through the graph's and
+/// nodes' maps. Ranges of the arrays are stored in CSR style, e.g., the arcs
+/// of node n are adj_arcs[adj_start[n]] to adj_arcs[adj_start[n + 1] - 1], in
+/// the order they were added to the graph.
+///
+/// A snapshot is only valid as long as the graph's groups, nodes, and arcs
+/// and the nodes' unit capacities and preferences are not changed.
+struct FlatExchangeGraph {
+  /// @throws StateError if an arc's nodes do not belong to the graph's groups
+  explicit FlatExchangeGraph(const ExchangeGraph& g);
+
+  /// @brief the id of node n, or -1 if it is not in the graph
+  int NodeId(const ExchangeNode* n) const;
+
+  /// @brief the unit capacities of arc a's unode (or vnode)
+  inline const double* ucaps(int a, bool unode) const {
+    return ucaps_data.data() + ucap_start[2 * a + (unode ? 0 : 1)];
+  }
+  inline int n_ucaps(int a, bool unode) const {
+    int i = 2 * a + (unode ? 0 : 1);
+    return ucap_start[i + 1] - ucap_start[i];
+  }
+
+  /// @brief the number of request groups, i.e., the groups with ids less than
+  /// nreq
+  int nreq;
+  std::vector<ExchangeNodeGroup*> groups;
+
+  /// @brief the nodes of each group
+  std::vector<int> group_start;
+
+  /// @brief the capacities of each group, indexed by cap_start
+  std::vector<double> caps;
+  std::vector<int> cap_start;
+
+  std::vector<ExchangeNode*> nodes;
+  std::vector<int> node_group;
+
+  /// @brief the arcs of each node
+  std::vector<int> adj_start;
+  std::vector<int> adj_arcs;
+
+  /// @brief the request (u) and bid (v) node of each arc
+  std::vector<int> arc_u;
+  std::vector<int> arc_v;
+
+  /// @brief the unode's preference for each arc (see ExchangeNode::prefs)
+  std::vector<double> u_pref;
+
+  /// @brief the unit capacities of each arc's unode and vnode (see ucaps())
+  std::vector<double> ucaps_data;
+  std::vector<int> ucap_start;
+
+  /// @brief the nodes sorted by address, see NodeId()
+  std::vector<std::pair<const ExchangeNode*, int> > node_index;
 };
 
 }  // namespace cyclus
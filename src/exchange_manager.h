@@ -2,6 +2,9 @@
 #define CYCLUS_SRC_EXCHANGE_MANAGER_H_
 
 #include <algorithm>
+#include <cstdlib>
+
+#include <boost/shared_ptr.hpp>
 
 #include "exchange_graph.h"
 #include "exchange_solver.h"
@@ -24,22 +27,64 @@ namespace cyclus {
 /// ExchangeManager<ResourceType> manager(ctx);
 /// manager.Execute();
 /// @endcode
+///
+/// Setting the CYCLUS_DRE_THREADS environment variable to a number greater
+/// than one enables the threaded exchange, in which requests and bids of
+/// thread safe traders (see Trader::ThreadSafeExchange) are collected
+/// concurrently and the connected components of the exchange graph are solved
+/// concurrently (see ExchangeSolver::nthreads).
+///
+/// The portfolios gathered on one time step are kept until the next, when
+/// those of traders that report them unchanged are reused (see
+/// Trader::MatlRequestsUnchanged and ResourceExchange::prev_history).
 template <class T>
 class ExchangeManager {
  public:
-  ExchangeManager(Context* ctx) : ctx_(ctx), debug_(false) {
+  ExchangeManager(Context* ctx) : ctx_(ctx), debug_(false), nthreads_(1) {
     debug_ = Env::GetEnv("CYCLUS_DEBUG_DRE").size() > 0;
+    std::string nthreads = Env::GetEnv("CYCLUS_DRE_THREADS");
+    if (nthreads.size() > 0) {
+      nthreads_ = std::max(1, std::atoi(nthreads.c_str()));
+    }
   }
 
+  /// @brief the number of threads used to collect requests and bids and to
+  /// solve the exchange
+  inline int nthreads() const { return nthreads_; }
+
+  /// @brief sets the number of threads used to collect requests and bids and
+  /// to solve the exchange
+  inline void nthreads(int n) { nthreads_ = n; }
+
   /// @brief execute the full resource sequence
   void Execute() {
-    // collect resource exchange information
-    ResourceExchange<T> exchng(ctx_);
-    exchng.AddAllRequests();
-    exchng.AddAllBids();
+    Gather();
+    Resolve();
+  }
+
+  /// @brief collects all requests and bids, the first half of Execute. Only
+  /// traders are called, so exchanges for different resource types may gather
+  /// concurrently.
+  void Gather() {
+    exchng_ = boost::shared_ptr< ResourceExchange<T> >(
+        new ResourceExchange<T>(ctx_));
+    exchng_->nthreads(nthreads_);
+    exchng_->prev_history(&history_);
+    exchng_->AddAllRequests();
+    exchng_->AddAllBids();
+    exchng_->prev_history(NULL);
+    history_ = exchng_->history();
+  }
+
+  /// @brief adjusts preferences, then translates, solves and executes the
+  /// exchange collected by the last call to Gather.
+  void Resolve() {
+    boost::shared_ptr< ResourceExchange<T> > exchng_ptr = exchng_;
+    exchng_.reset();
+    ResourceExchange<T>& exchng = *exchng_ptr;
     exchng.AdjustAll();
     CLOG(LEV_DEBUG1) << "done with info gathering";
-    
+
     if (debug_)
       RecordDebugInfo(exchng.ex_ctx());
 
@@ -54,7 +99,10 @@ class ExchangeManager {
 
     // solve graph
     CLOG(LEV_DEBUG1) << "solving graph...";
-    ctx_->solver()->Solve(graph.get());
+    ExchangeSolver* solver = ctx_->solver();
+    if (nthreads_ > 1)
+      solver->nthreads(nthreads_);
+    solver->Solve(graph.get());
     CLOG(LEV_DEBUG1) << "graph solved!";
 
     // get trades
@@ -113,7 +161,10 @@ class ExchangeManager {
   }
 
   bool debug_;
+  int nthreads_;
   Context* ctx_;
+  boost::shared_ptr< ResourceExchange<T> > exchng_;
+  ExchangeHistory<T> history_;
 };
 
 }  // namespace cyclus
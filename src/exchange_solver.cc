@@ -1,10 +1,12 @@
 #include "exchange_solver.h"
 
+#include <algorithm>
 #include <vector>
 #include <map>
 
 #include "context.h"
 #include "exchange_graph.h"
+#include "parallel.h"
 
 namespace cyclus {
 
@@ -96,4 +98,53 @@ double ExchangeSolver::PseudoCostByPref(double cost_factor) {
   return max_cost * (1 + cost_factor);
 }
 
+double ExchangeSolver::SolveComponents() {
+  ExchangeGraph* whole = graph_;
+  std::vector<ExchangeGraph::Ptr> comps = whole->ConnectedComponents();
+  if (comps.size() < 2)
+    return SolveGraph();
+
+  // this solver serves the calling thread, clones serve the workers
+  int nthreads = std::min<int>(nthreads_, comps.size());
+  std::vector<ExchangeSolver*> solvers(1, this);
+  for (int i = 1; i < nthreads; ++i) {
+    ExchangeSolver* s = Clone();
+    if (s == NULL)
+      break;
+    s->sim_ctx_ = sim_ctx_;
+    s->verbose_ = verbose_;
+    solvers.push_back(s);
+  }
+
+  std::vector<double> objs(comps.size(), 0);
+  try {
+    ParallelFor(comps.size(), solvers.size(), [&](int i, int thread) {
+      ExchangeSolver* s = solvers[thread];
+      s->graph_ = comps[i].get();
+      s->component_ = i;
+      objs[i] = s->SolveGraph();
+    });
+  } catch (...) {
+    graph_ = whole;
+    component_ = -1;
+    for (int i = 1; i < solvers.size(); ++i)
+      delete solvers[i];
+    throw;
+  }
+  graph_ = whole;
+  component_ = -1;
+  for (int i = 1; i < solvers.size(); ++i)
+    delete solvers[i];
+
+  double obj = 0;
+  for (int i = 0; i < comps.size(); ++i) {
+    const std::vector<Match>& matches = comps[i]->matches();
+    for (int j = 0; j < matches.size(); ++j) {
+      graph_->AddMatch(matches[j].first, matches[j].second);
+    }
+    obj += objs[i];
+  }
+  return obj;
+}
+
 } // namespace cyclus
@@ -23,7 +23,9 @@ class ExchangeSolver {
   explicit ExchangeSolver(bool exclusive_orders = kDefaultExclusive)
     : exclusive_orders_(exclusive_orders),
       sim_ctx_(NULL),
-      verbose_(false) {}
+      verbose_(false),
+      nthreads_(1),
+      component_(-1) {}
   virtual ~ExchangeSolver() {}
 
   /// simulation context get/set
@@ -37,14 +39,30 @@ class ExchangeSolver {
   inline void graph(ExchangeGraph* graph) { graph_ = graph; }
   inline ExchangeGraph* graph() const { return graph_; }
 
+  /// the number of threads used to solve a graph. If greater than one, the
+  /// graph is split into its connected components, which are solved
+  /// independently and their matches merged in component order.
+  /// @{
+  inline void nthreads(int n) { nthreads_ = n; }
+  inline int nthreads() const { return nthreads_; }
+  /// @}
+
   /// @brief interface for solving a given exchange graph
   /// @param a pointer to the graph to be solved
   double Solve(ExchangeGraph* graph = NULL) {
     if (graph != NULL)
       graph_ = graph;
+    if (nthreads_ > 1)
+      return SolveComponents();
     return this->SolveGraph();
   }
 
+  /// @brief returns a new solver with the same configuration as this one, used
+  /// to solve components of a graph concurrently. Solvers that can not be
+  /// cloned return NULL (the default), in which case components are solved
+  /// one after another by this solver.
+  virtual ExchangeSolver* Clone() const { return NULL; }
+
   /// @brief Calculates the ratio of the maximum objective coefficient to
   /// minimum unit capacity plus an added cost. This is guaranteed to be larger
   /// than any other arc cost measure and can be used as a cost for unmet
@@ -65,10 +83,21 @@ class ExchangeSolver {
   /// @brief Worker function for solving a graph. This must be implemented by
   /// any solver.
   virtual double SolveGraph() = 0;
+
+  /// @brief solves each connected component of the graph on up to nthreads
+  /// solvers and merges the matches back into the graph.
+  /// @return the sum of the component objective values
+  double SolveComponents();
+
   ExchangeGraph* graph_;
   bool exclusive_orders_;
   bool verbose_;
   Context* sim_ctx_;
+  int nthreads_;
+
+  /// the index of the connected component being solved by SolveComponents,
+  /// or -1 while solving a whole graph
+  int component_;
 };
 
 }  // namespace cyclus
@@ -2,6 +2,7 @@
 #define CYCLUS_SRC_EXCHANGE_TRANSLATION_CONTEXT_H_
 
 #include <map>
+#include <utility>
 
 #include "bid.h"
 #include "exchange_graph.h"
@@ -9,6 +10,8 @@
 
 namespace cyclus {
 
+template <class T> struct Converter;
+
 /// @class ExchangeTranslationContext
 ///
 /// @brief An ExchangeTranslationContext is a simple holder class for any
@@ -21,6 +24,13 @@ struct ExchangeTranslationContext {
   std::map<ExchangeNode::Ptr, Request<T>*> node_to_request;
   std::map<Bid<T>*, ExchangeNode::Ptr> bid_to_node;
   std::map<ExchangeNode::Ptr, Bid<T>*> node_to_bid;
+
+  /// @brief a pure converter, an offer's quality id and its quantity
+  typedef std::pair<const Converter<T>*, std::pair<int, double> > ConvertKey;
+
+  /// @brief the results of pure converters (see Converter::pure()) during the
+  /// translation of an exchange
+  mutable std::map<ConvertKey, double> converted;
 };
 
 }  // namespace cyclus
@@ -1,6 +1,7 @@
 #ifndef CYCLUS_SRC_EXCHANGE_TRANSLATOR_H_
 #define CYCLUS_SRC_EXCHANGE_TRANSLATOR_H_
 
+#include <algorithm>
 #include <sstream>
 
 #include "bid.h"
@@ -49,8 +50,12 @@ class ExchangeTranslator {
     typename std::vector<typename RequestPortfolio<T>::Ptr>::const_iterator
         rp_it;
     for (rp_it = requests.begin(); rp_it != requests.end(); ++rp_it) {
+      // portfolios reused from a previous exchange already have the constraint
       CapacityConstraint<T> c((*rp_it)->qty(), (*rp_it)->qty_converter());
-      (*rp_it)->AddConstraint(c);
+      const std::set< CapacityConstraint<T> >& cs = (*rp_it)->constraints();
+      if (std::find(cs.begin(), cs.end(), c) == cs.end()) {
+        (*rp_it)->AddConstraint(c);
+      }
 
       RequestGroup::Ptr rs = TranslateRequestPortfolio(xlation_ctx_, *rp_it);
       graph->AddRequestGroup(rs);
@@ -106,14 +111,26 @@ class ExchangeTranslator {
     graph->AddArc(a);
   }
   
-  /// @brief Provide a vector of Trades given a vector of Matches
+  /// @brief Provide a vector of Trades given a vector of Matches. A match of
+  /// several units of a bid with a multiplicity greater than one is expanded
+  /// into one trade per unit.
   void BackTranslateSolution(const std::vector<Match>& matches,
                              std::vector< Trade<T> >& ret) {
     std::vector<Match>::const_iterator m_it;
     CLOG(LEV_DEBUG1) << "Back traslating " << matches.size()
                      << " trade matches.";
     for (m_it = matches.begin(); m_it != matches.end(); ++m_it) {
-      ret.push_back(BackTranslateMatch(xlation_ctx_, *m_it));
+      Trade<T> t = BackTranslateMatch(xlation_ctx_, *m_it);
+      const Arc& a = m_it->first;
+      int n = 1;
+      if (t.bid->multiplicity() > 1 && a.exclusive() && a.excl_val() > 0) {
+        n = static_cast<int>(t.amt / a.excl_val() + 0.5);
+        n = std::max(1, std::min(n, a.excl_units()));
+        t.amt /= n;
+      }
+      for (int i = 0; i < n; ++i) {
+        ret.push_back(t);
+      }
     }
   }
 
@@ -201,6 +218,7 @@ ExchangeNodeGroup::Ptr TranslateBidPortfolio(
                          b->exclusive(),
                          b->request()->commodity(),
                          b->bidder()->manager()->id()));
+    n->multiplicity = b->multiplicity();
     bs->AddExchangeNode(n);
     AddBid(translation_ctx, *b_it, n);
     if (b->exclusive()) {
@@ -284,10 +302,9 @@ void TranslateCapacities(
     const ExchangeTranslationContext<T>& ctx) {
   typename std::set< CapacityConstraint<T> >::const_iterator it;
   for (it = constr.begin(); it != constr.end(); ++it) {
-    CLOG(cyclus::LEV_DEBUG1) << "Additing unit capacity: "
-                             << it->convert(offer, &a, &ctx) / offer->quantity();
-    n->unit_capacities[a].push_back(it->convert(offer, &a, &ctx) /
-                                    offer->quantity());
+    double ucap = it->convert(offer, &a, &ctx) / offer->quantity();
+    CLOG(cyclus::LEV_DEBUG1) << "Additing unit capacity: " << ucap;
+    n->unit_capacities[a].push_back(ucap);
   }
 }
 
@@ -38,6 +38,13 @@ GreedySolver::~GreedySolver() {
     delete conditioner_;
 }
 
+ExchangeSolver* GreedySolver::Clone() const {
+  GreedyPreconditioner* c = NULL;
+  if (conditioner_ != NULL)
+    c = new GreedyPreconditioner(*conditioner_);
+  return new GreedySolver(exclusive_orders_, c);
+}
+
 void GreedySolver::Condition() {
   if (conditioner_ != NULL)
     conditioner_->Condition(graph_);
@@ -62,20 +69,77 @@ double GreedySolver::SolveGraph() {
   Condition();
   obj_ = 0;
   unmatched_ = 0;
-  n_qty_.clear();
-  
-  Init();
- 
-  std::for_each(graph_->request_groups().begin(),
-                graph_->request_groups().end(),
-                std::bind1st(
-                    std::mem_fun(&GreedySolver::GreedilySatisfySet),
-                    this));
+
+  // requests are matched in order of their average preference
+  std::vector<RequestGroup::Ptr>& rgs = graph_->request_groups();
+  for (int i = 0; i != rgs.size(); i++) {
+    std::stable_sort(rgs[i]->nodes().begin(), rgs[i]->nodes().end(),
+                     AvgPrefComp);
+  }
+
+  FlatExchangeGraph g(*graph_);
+  flat_qty_.assign(g.nodes.size(), 0);
+  flat_caps_ = g.caps;
+  for (int i = 0; i != g.nreq; i++) {
+    GreedilySatisfySet(g, i);
+  }
 
   obj_ += unmatched_ * pseudo_cost;
   return obj_;
 }
 
+namespace {
+/// the capacity of a node with n unit capacities in a group with capacities
+/// grp_caps that has qty left
+double NodeCapacity(const double* unit_caps, const double* grp_caps, int n,
+                    bool min_cap, double qty) {
+  std::vector<double> caps;
+  double grp_cap, u_cap, cap;
+
+  for (int i = 0; i < n; i++) {
+    grp_cap = grp_caps[i];
+    u_cap = unit_caps[i];
+    cap = grp_cap / u_cap;
+    CLOG(cyclus::LEV_DEBUG1) << "Capacity for node: ";
+    CLOG(cyclus::LEV_DEBUG1) << "   group capacity: " << grp_cap;
+    CLOG(cyclus::LEV_DEBUG1) << "    unit capacity: " << u_cap;
+    CLOG(cyclus::LEV_DEBUG1) << "         capacity: " << cap;
+
+    // special case for unlimited capacities
+    if (grp_cap == std::numeric_limits<double>::max()) {
+      caps.push_back(std::numeric_limits<double>::max());
+    } else {
+      caps.push_back(cap);
+    }
+  }
+
+  if (min_cap) {  // the smallest value is constraining (for bids)
+    cap = *std::min_element(caps.begin(), caps.end());
+  } else {  // the largest value must be met (for requests)
+    cap = *std::max_element(caps.begin(), caps.end());
+  }
+  return std::min(cap, qty);
+}
+
+/// ReqPrefComp for the ids of the arcs of a FlatExchangeGraph
+struct FlatReqPrefComp {
+  explicit FlatReqPrefComp(const FlatExchangeGraph& g) : g(g) {}
+
+  bool operator()(int l, int r) const {
+    int lu = g.nodes[g.arc_u[l]]->agent_id;
+    int lv = g.nodes[g.arc_v[l]]->agent_id;
+    int ru = g.nodes[g.arc_u[r]]->agent_id;
+    int rv = g.nodes[g.arc_v[r]]->agent_id;
+    double lpref = g.u_pref[l];
+    double rpref = g.u_pref[r];
+    return (lpref != rpref) ? (lpref > rpref) :
+        (lu > ru || (lu == ru && lv > rv));
+  }
+
+  const FlatExchangeGraph& g;
+};
+}  // namespace
+
 double GreedySolver::Capacity(const Arc& a, double u_curr_qty,
                                double v_curr_qty) {
   bool min = true;
@@ -96,38 +160,27 @@ double GreedySolver::Capacity(ExchangeNode::Ptr n, const Arc& a, bool min_cap,
     throw cyclus::StateError("An notion of node capacity requires a nodegroup.");
   }
 
+  double qty = n->qty * n->multiplicity;
   if (n->unit_capacities[a].size() == 0) {
-    return n->qty - curr_qty;
+    return qty - curr_qty;
   }
 
   std::vector<double>& unit_caps = n->unit_capacities[a];
   const std::vector<double>& group_caps = grp_caps_[n->group];
-  std::vector<double> caps;
-  double grp_cap, u_cap, cap;
-
-  for (int i = 0; i < unit_caps.size(); i++) {
-    grp_cap = group_caps[i];
-    u_cap = unit_caps[i];
-    cap = grp_cap / u_cap;
-    CLOG(cyclus::LEV_DEBUG1) << "Capacity for node: ";
-    CLOG(cyclus::LEV_DEBUG1) << "   group capacity: " << grp_cap;
-    CLOG(cyclus::LEV_DEBUG1) << "    unit capacity: " << u_cap;
-    CLOG(cyclus::LEV_DEBUG1) << "         capacity: " << cap;
-
-    // special case for unlimited capacities
-    if (grp_cap == std::numeric_limits<double>::max()) {
-      caps.push_back(std::numeric_limits<double>::max());
-    } else {
-      caps.push_back(cap);
-    }
-  }
+  return NodeCapacity(&unit_caps[0], &group_caps[0], unit_caps.size(),
+                      min_cap, qty - curr_qty);
+}
 
-  if (min_cap) {  // the smallest value is constraining (for bids)
-    cap = *std::min_element(caps.begin(), caps.end());
-  } else {  // the largest value must be met (for requests)
-    cap = *std::max_element(caps.begin(), caps.end());
+double GreedySolver::Capacity(const FlatExchangeGraph& g, int a, bool unode) {
+  int n = unode ? g.arc_u[a] : g.arc_v[a];
+  double qty = g.nodes[n]->qty * g.nodes[n]->multiplicity - flat_qty_[n];
+  if (g.n_ucaps(a, unode) == 0) {
+    return qty;
   }
-  return std::min(cap, n->qty - curr_qty);
+  // the requester's capacities must be met, the bidder's are constraining
+  return NodeCapacity(g.ucaps(a, unode),
+                      &flat_caps_[g.cap_start[g.node_group[n]]],
+                      g.n_ucaps(a, unode), !unode, qty);
 }
 
 void GreedySolver::GetCaps(ExchangeNodeGroup::Ptr g) {
@@ -137,90 +190,97 @@ void GreedySolver::GetCaps(ExchangeNodeGroup::Ptr g) {
   grp_caps_[g.get()] = g->capacities();
 }
 
-void GreedySolver::GreedilySatisfySet(RequestGroup::Ptr prs) {
-  std::vector<ExchangeNode::Ptr>& nodes = prs->nodes();
-  std::stable_sort(nodes.begin(), nodes.end(), AvgPrefComp);
-
-  std::vector<ExchangeNode::Ptr>::iterator req_it = nodes.begin();
-  double target = prs->qty();
+void GreedySolver::GreedilySatisfySet(const FlatExchangeGraph& g, int grp) {
+  const std::vector<Arc>& arcs = graph_->arcs();
+  double target = static_cast<RequestGroup*>(g.groups[grp])->qty();
   double match = 0;
 
-  ExchangeNode::Ptr u, v;
-  std::vector<Arc>::const_iterator arc_it;
-  std::vector<Arc> sorted;
+  std::vector<int> sorted;
   double remain, tomatch, excl_val;
 
   CLOG(LEV_DEBUG1) << "Greedy Solving for " << target
                    << " amount of a resource.";
 
-  while ((match <= target) && (req_it != nodes.end())) {
-    // this if statement is needed because map.at() will throw if the key does
-    // not exist, which is a corner case for when there is a request with no bid
-    // arcs associated with it
-    if (graph_->node_arc_map().count(*req_it) > 0) {
-      const std::vector<Arc>& arcs = graph_->node_arc_map().at(*req_it);
-      sorted = std::vector<Arc>(arcs);  // make a copy for now
-      std::stable_sort(sorted.begin(), sorted.end(), ReqPrefComp);
-      arc_it = sorted.begin();
-
-      while ((match <= target) && (arc_it != sorted.end())) {
-        remain = target - match;
-        const Arc& a = *arc_it;
-        u = a.unode();
-        v = a.vnode();
-        // capacity adjustment
-        tomatch = std::min(remain, Capacity(a, n_qty_[u], n_qty_[v]));
-
-        // exclusivity adjustment
-        if (arc_it->exclusive()) {
-          excl_val = a.excl_val();
-
-          // this careful float comparison is vital for preventing false positive
-          // constraint violations w.r.t. exclusivity-related capacity.
-          double dist = boost::math::float_distance(tomatch, excl_val);
-          if (dist >= float_ulp_eq ) {
-            tomatch = 0;
-          } else {
-            tomatch = excl_val;
-          }
-        }
-
-        if (tomatch > eps()) {
-          CLOG(LEV_DEBUG1) << "Greedy Solver is matching " << tomatch
-                           << " amount of a resource.";
-          UpdateCapacity(u, a, tomatch);
-          UpdateCapacity(v, a, tomatch);
-          n_qty_[u] += tomatch;
-          n_qty_[v] += tomatch;
-          graph_->AddMatch(a, tomatch);
-
-          match += tomatch;
-          UpdateObj(tomatch, u->prefs[a]);
+  int n = g.group_start[grp];
+  while ((match <= target) && (n != g.group_start[grp + 1])) {
+    sorted.assign(g.adj_arcs.begin() + g.adj_start[n],
+                  g.adj_arcs.begin() + g.adj_start[n + 1]);
+    std::stable_sort(sorted.begin(), sorted.end(), FlatReqPrefComp(g));
+    std::vector<int>::const_iterator arc_it = sorted.begin();
+
+    while ((match <= target) && (arc_it != sorted.end())) {
+      remain = target - match;
+      const Arc& a = arcs[*arc_it];
+      // capacity adjustment
+      tomatch = std::min(remain, std::min(Capacity(g, *arc_it, true),
+                                          Capacity(g, *arc_it, false)));
+
+      // exclusivity adjustment
+      if (a.exclusive() && a.excl_units() > 1) {
+        tomatch = ExclUnits(tomatch, a) * a.excl_val();
+      } else if (a.exclusive()) {
+        excl_val = a.excl_val();
+
+        // this careful float comparison is vital for preventing false positive
+        // constraint violations w.r.t. exclusivity-related capacity.
+        double dist = boost::math::float_distance(tomatch, excl_val);
+        if (dist >= float_ulp_eq ) {
+          tomatch = 0;
+        } else {
+          tomatch = excl_val;
         }
-        ++arc_it;
-      }  // while( (match =< target) && (arc_it != arcs.end()) )
-    }  // if(graph_->node_arc_map().count(*req_it) > 0)
-    ++req_it;
-  }  // while( (match =< target) && (req_it != nodes.end()) )
+      }
+
+      if (tomatch > eps()) {
+        CLOG(LEV_DEBUG1) << "Greedy Solver is matching " << tomatch
+                         << " amount of a resource.";
+        UpdateCapacity(g, *arc_it, true, tomatch);
+        UpdateCapacity(g, *arc_it, false, tomatch);
+        graph_->AddMatch(a, tomatch);
+
+        match += tomatch;
+        UpdateObj(tomatch, g.u_pref[*arc_it]);
+      }
+      ++arc_it;
+    }  // while( (match =< target) && (arc_it != sorted.end()) )
+    ++n;
+  }  // while( (match =< target) && (n != end of the group's nodes) )
 
   unmatched_ += target - match;
 }
 
+int GreedySolver::ExclUnits(double qty, const Arc& a) {
+  double excl_val = a.excl_val();
+  if (excl_val <= 0) {
+    return 0;
+  }
+  int n = std::min(static_cast<int>(qty / excl_val), a.excl_units());
+  // the same careful float comparison as for a single exclusive unit
+  if (n < a.excl_units() &&
+      boost::math::float_distance(qty, (n + 1) * excl_val) < float_ulp_eq) {
+    ++n;
+  }
+  return n;
+}
+
 void GreedySolver::UpdateObj(double qty, double pref) {
   // updates minimizing object (i.e., 1/pref is a cost and the objective is cost
   // * flow)
   obj_ += qty / pref;
 }
 
-void GreedySolver::UpdateCapacity(ExchangeNode::Ptr n, const Arc& a,
-                                  double qty) {
+void GreedySolver::UpdateCapacity(const FlatExchangeGraph& g, int a,
+                                  bool unode, double qty) {
   using cyclus::IsNegative;
   using cyclus::ValueError;
 
-  std::vector<double>& unit_caps = n->unit_capacities[a];
-  std::vector<double>& caps = grp_caps_[n->group];
-  assert(unit_caps.size() == caps.size());
-  for (int i = 0; i < caps.size(); i++) {
+  int n = unode ? g.arc_u[a] : g.arc_v[a];
+  int grp = g.node_group[n];
+  const double* unit_caps = g.ucaps(a, unode);
+  double* caps = &flat_caps_[0] + g.cap_start[grp];
+  int ncaps = g.cap_start[grp + 1] - g.cap_start[grp];
+  assert(g.n_ucaps(a, unode) == ncaps);
+  for (int i = 0; i < ncaps; i++) {
     double prev = caps[i];
     // special case for unlimited capacities
     CLOG(cyclus::LEV_DEBUG1) << "Updating capacity value from: "
@@ -232,14 +292,16 @@ void GreedySolver::UpdateCapacity(ExchangeNode::Ptr n, const Arc& a,
                              << caps[i];
   }
 
-  if (IsNegative(n->qty - qty)) {
+  ExchangeNode* node = g.nodes[n];
+  if (IsNegative(node->qty * node->multiplicity - qty)) {
     std::stringstream ss;
-    ss << "A bid for " << n->commod << " was set at " << n->qty
+    ss << "A bid for " << node->commod << " was set at " << node->qty
        << " but has been matched to a higher value " << qty
        << ". This could be due to a problem with your "
        << "bid portfolio constraints.";
     throw ValueError(ss.str());
   }
+  flat_qty_[n] += qty;
 }
 
 }  // namespace cyclus
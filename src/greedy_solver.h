@@ -76,6 +76,10 @@ class GreedySolver: public ExchangeSolver {
   
   virtual ~GreedySolver();
 
+  /// @brief a new GreedySolver with the same exclusivity and a copy of this
+  /// solver's conditioner
+  virtual ExchangeSolver* Clone() const;
+
   /// Uses the provided (or a default) GreedyPreconditioner to condition the
   /// solver's ExchangeGraph so that RequestGroups are ordered by average
   /// preference and commodity weight.
@@ -84,7 +88,8 @@ class GreedySolver: public ExchangeSolver {
   /// likely not be called independently thereof (except for testing)
   void Condition();
 
-  /// Initialize member values based on the given graph.
+  /// Initializes the node quantities and group capacities used by the public
+  /// Capacity member functions from the given graph.
   void Init();
 
   /// @brief the capacity of the arc
@@ -142,13 +147,26 @@ class GreedySolver: public ExchangeSolver {
   /// @param n the ExchangeNode
   /// @param qty the quantity for the node to update
   void GetCaps(ExchangeNodeGroup::Ptr prs);
-  void GreedilySatisfySet(RequestGroup::Ptr prs);
-  void UpdateCapacity(ExchangeNode::Ptr n, const Arc& a, double qty);
+  void GreedilySatisfySet(const FlatExchangeGraph& g, int grp);
+  void UpdateCapacity(const FlatExchangeGraph& g, int a, bool unode,
+                      double qty);
   void UpdateObj(double qty, double pref);
-  
+
+  /// @brief the capacity of arc a's unode (or vnode) during a solve
+  double Capacity(const FlatExchangeGraph& g, int a, bool unode);
+
+  /// @brief the number of whole exclusive units of an arc with more than one
+  /// unit that fit into qty
+  int ExclUnits(double qty, const Arc& a);
+
   GreedyPreconditioner* conditioner_;
   std::map<ExchangeNode::Ptr, double> n_qty_;
   std::map<ExchangeNodeGroup*, std::vector<double> > grp_caps_;
+
+  /// @brief the matched quantity of each node and the remaining capacities of
+  /// each group during a solve, indexed as in the solve's FlatExchangeGraph
+  std::vector<double> flat_qty_;
+  std::vector<double> flat_caps_;
   double obj_;
   double unmatched_;
 };
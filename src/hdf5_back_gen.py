@@ -1745,22 +1745,18 @@ def main_fill_buf():
     output = indent(output, INDENT*4)
     return output
 
-vl_write_vl_string = """hasher_.Clear();
-hasher_.Update({var});
-Digest {key} = hasher_.digest();
+vl_write_vl_string = """Digest {key} = VLHash({var});
 hid_t {keysds} = VLDataset({t.db}, true);
 hid_t {valsds} = VLDataset({t.db}, false);
-if (vlkeys_[{t.db}].count({key}) != 1) {{
+if (!HasVLKey({t.db}, {key})) {{
   AppendVLKey({keysds}, {t.db}, {key});
   InsertVLVal({valsds}, {t.db}, {key}, {var});
 }}\n"""
 
-vl_write_blob = """hasher_.Clear();
-hasher_.Update({var});
-Digest {key} = hasher_.digest();
+vl_write_blob = """Digest {key} = VLHash(({var}).str());
 hid_t {keysds} = VLDataset({t.db}, true);
 hid_t {valsds} = VLDataset({t.db}, false);
-if (vlkeys_[{t.db}].count({key}) != 1) {{
+if (!HasVLKey({t.db}, {key})) {{
   AppendVLKey({keysds}, {t.db}, {key});
   InsertVLVal({valsds}, {t.db}, {key}, ({var}).str());
 }}\n"""
@@ -1785,7 +1781,7 @@ hasher_.Update({var});
 Digest {key} = hasher_.digest();
 hid_t {keysds} = VLDataset({t.db}, true);
 hid_t {valsds} = VLDataset({t.db}, false);
-if (vlkeys_[{t.db}].count({key}) != 1) {{
+if (!HasVLKey({t.db}, {key})) {{
   hvl_t {buf} = VLValToBuf({var});
   AppendVLKey({keysds}, {t.db}, {key});
   InsertVLVal({valsds}, {t.db}, {key}, {buf});
@@ -1822,8 +1818,15 @@ def a_cast(t, depth=0, prefix=""):
                                                 value=Raw(code=cast_string))))
     else:
         cast_string = "a->cast<" + t.cpp + ">()"
+        # Values that are only read from may bind by reference rather than
+        # copying the held value. Fixed-length containers are truncated in
+        # place, so they still need their own copy.
+        if is_primitive(t) or is_all_vl(t):
+            val_type = Type(cpp="const " + t.cpp + "&", db=t.db, canon=t.canon)
+        else:
+            val_type = t
         cast.nodes.append(ExprStmt(child=DeclAssign(
-                                                  type=t,
+                                                  type=val_type,
                                                   target=Var(name=val),
                                                   value=Raw(code=cast_string))))
     return cast
@@ -2331,7 +2334,7 @@ def main_write():
                        name=Var(name="Hdf5Back::WriteToBuf"),
                        targs=[Raw(code=t.db)],
                        args=[Decl(type=Type(cpp="char*"), name=Var(name="buf")),
-                             Decl(type=Type(cpp="std::vector<int>&"),
+                             Decl(type=Type(cpp="const std::vector<int>&"),
                                   name=Var(name="shape")),
                              Decl(type=Type(
                                           cpp="const boost::spirit::hold_any*"),
@@ -1,8 +1,11 @@
 #include "material.h"
 
 #include <math.h>
+#include <map>
+#include <set>
 
 #include "comp_math.h"
+#include "comp_vec.h"
 #include "context.h"
 #include "decayer.h"
 #include "error.h"
@@ -77,13 +80,13 @@ Material::Ptr Material::ExtractComp(double qty, Composition::Ptr c,
 
   // TODO: decide if ExtractComp should force lazy-decay by calling comp()
   if (comp_ != c) {
-    CompMap v(comp_->mass());
-    compmath::Normalize(&v, qty_);
-    CompMap otherv(c->mass());
-    compmath::Normalize(&otherv, qty);
-    CompMap newv = compmath::Sub(v, otherv);
-    compmath::ApplyThreshold(&newv, threshold);
-    comp_ = Composition::CreateFromMass(newv);
+    CompVec v(comp_->mass());
+    v.Normalize(qty_);
+    CompVec otherv(c->mass());
+    otherv.Normalize(qty);
+    CompVec newv = CompVec::Sub(v, otherv);
+    newv.ApplyThreshold(threshold);
+    comp_ = Composition::CreateFromMass(newv.ToCompMap());
   }
 
   qty_ -= qty;
@@ -105,11 +108,11 @@ void Material::Absorb(Material::Ptr mat) {
   Composition::Ptr c1 = mat->comp();
 
   if (c0 != c1) {
-    CompMap v(c0->mass());
-    compmath::Normalize(&v, qty_);
-    CompMap otherv(c1->mass());
-    compmath::Normalize(&otherv, mat->qty_);
-    comp_ = Composition::CreateFromMass(compmath::Add(v, otherv));
+    CompVec v(c0->mass());
+    v.Normalize(qty_);
+    CompVec otherv(c1->mass());
+    otherv.Normalize(mat->qty_);
+    comp_ = Composition::CreateFromMass(CompVec::Add(v, otherv).ToCompMap());
   }
 
   // Set the decay time to the value of the material that had the larger
@@ -142,19 +145,71 @@ void Material::Transmute(Composition::Ptr c) {
 }
 
 void Material::Decay(int curr_time) {
-  if (ctx_ != NULL && ctx_->sim_info().decay == "never") {
+  int dt;
+  uint64_t secs_per_timestep;
+  if (!DecayStep(&curr_time, &dt, &secs_per_timestep)) {
     return;
-  } else if (curr_time < 0 && ctx_ == NULL) {
+  }
+
+  prev_decay_time_ = curr_time; // this must go before Transmute call
+  Composition::Ptr decayed = comp_->Decay(dt, secs_per_timestep);
+  Transmute(decayed);
+}
+
+void Material::DecayMany(const std::vector<Material::Ptr>& mats,
+                         int curr_time) {
+  typedef std::pair<int, uint64_t> Step;
+  std::map<Step, std::vector<Composition::Ptr> > comps;
+  std::vector<Material*> todo;
+  std::vector<Step> steps;
+  std::vector<int> times;
+  std::set<Material*> seen;
+  for (int i = 0; i < mats.size(); ++i) {
+    Material* m = mats[i].get();
+    int t = curr_time;
+    Step step;
+    if (!seen.insert(m).second ||
+        !m->DecayStep(&t, &step.first, &step.second)) {
+      continue;
+    }
+    todo.push_back(m);
+    steps.push_back(step);
+    times.push_back(t);
+    comps[step].push_back(m->comp_);
+  }
+
+  // decay each group in one batch
+  std::map<Step, std::vector<Composition::Ptr> > decayed;
+  std::map<Step, std::vector<Composition::Ptr> >::iterator it;
+  for (it = comps.begin(); it != comps.end(); ++it) {
+    decayed[it->first] = Composition::DecayMany(it->second, it->first.first,
+                                                it->first.second);
+  }
+
+  // transmute in the original order so resource state ids are assigned as
+  // they would be by calling Decay on each material
+  std::map<Step, int> next;
+  for (int i = 0; i < todo.size(); ++i) {
+    todo[i]->prev_decay_time_ = times[i];  // this must go before Transmute
+    todo[i]->Transmute(decayed[steps[i]][next[steps[i]]++]);
+  }
+}
+
+bool Material::DecayStep(int* curr_time, int* dt,
+                         uint64_t* secs_per_timestep) {
+  if (ctx_ != NULL && ctx_->sim_info().decay == "never") {
+    return false;
+  } else if (*curr_time < 0 && ctx_ == NULL) {
     throw ValueError("decay cannot use default time with NULL context");
   }
 
-  if (curr_time < 0) {
-    curr_time = ctx_->time();
+  if (*curr_time < 0) {
+    *curr_time = ctx_->time();
   }
 
-  int dt = curr_time - prev_decay_time_;
-  if (dt == 0) {
-    return;
+  *dt = *curr_time - prev_decay_time_;
+  if (*dt == 0) {
+    return false;
   }
 
   double eps = 1e-3;
@@ -164,9 +219,9 @@ void Material::Decay(int curr_time) {
   // just do the decay rather than check all the decay constants.
   bool decay = c.size() > 100;
 
-  uint64_t secs_per_timestep = kDefaultTimeStepDur;
+  *secs_per_timestep = kDefaultTimeStepDur;
   if (ctx_ != NULL) {
-    secs_per_timestep = ctx_->sim_info().dt;
+    *secs_per_timestep = ctx_->sim_info().dt;
   }
 
   if (!decay) {
@@ -176,21 +231,15 @@ void Material::Decay(int curr_time) {
     CompMap::const_reverse_iterator it;
     for (it = c.rbegin(); it != c.rend(); ++it) {
       int nuc = it->first;
-      double lambda_timesteps = pyne::decay_const(nuc) * static_cast<double>(secs_per_timestep);
-      double change = 1.0 - std::exp(-lambda_timesteps * static_cast<double>(dt));
+      double lambda_timesteps = pyne::decay_const(nuc) * static_cast<double>(*secs_per_timestep);
+      double change = 1.0 - std::exp(-lambda_timesteps * static_cast<double>(*dt));
       if (change >= eps) {
         decay = true;
         break;
       }
     }
-    if (!decay) {
-      return;
-    }
   }
-
-  prev_decay_time_ = curr_time; // this must go before Transmute call
-  Composition::Ptr decayed = comp_->Decay(dt, secs_per_timestep);
-  Transmute(decayed);
+  return decay;
 }
 
 double Material::DecayHeat() {
@@ -218,6 +267,54 @@ Composition::Ptr Material::comp() {
   return comp_;
 }
 
+Composition::Ptr Material::DecayedComp() {
+  if (ctx_ == NULL || ctx_->sim_info().decay != "lazy") {
+    return comp_;
+  }
+
+  int curr_time = -1;
+  int dt;
+  uint64_t secs_per_timestep;
+  if (!DecayStep(&curr_time, &dt, &secs_per_timestep)) {
+    return comp_;
+  }
+  return comp_->Decay(dt, secs_per_timestep);
+}
+
+std::vector<Composition::Ptr> Material::DecayedComps(
+    const std::vector<Material::Ptr>& mats) {
+  typedef std::pair<int, uint64_t> Step;
+  std::vector<Composition::Ptr> comps(mats.size());
+  std::map<Step, std::vector<int> > groups;
+  for (int i = 0; i < mats.size(); ++i) {
+    Material* m = mats[i].get();
+    comps[i] = m->comp_;
+    int t = -1;
+    Step step;
+    if (m->ctx_ == NULL || m->ctx_->sim_info().decay != "lazy" ||
+        !m->DecayStep(&t, &step.first, &step.second)) {
+      continue;
+    }
+    groups[step].push_back(i);
+  }
+
+  // decay each group in one batch
+  std::map<Step, std::vector<int> >::iterator it;
+  for (it = groups.begin(); it != groups.end(); ++it) {
+    const std::vector<int>& idx = it->second;
+    std::vector<Composition::Ptr> batch;
+    for (int j = 0; j < idx.size(); ++j) {
+      batch.push_back(comps[idx[j]]);
+    }
+    std::vector<Composition::Ptr> decayed =
+        Composition::DecayMany(batch, it->first.first, it->first.second);
+    for (int j = 0; j < idx.size(); ++j) {
+      comps[idx[j]] = decayed[j];
+    }
+  }
+  return comps;
+}
+
 Material::Material(Context* ctx, double quantity, Composition::Ptr c)
     : qty_(quantity),
       comp_(c),
@@ -2,6 +2,7 @@
 #define CYCLUS_SRC_MATERIAL_H_
 
 #include <list>
+#include <vector>
 #include <boost/shared_ptr.hpp>
 
 #include "composition.h"
@@ -138,6 +139,11 @@ class Material: public Resource {
   /// constants are significant with respect to the time delta.
   void Decay(int curr_time);
 
+  /// Decays every material in mats as if Decay(curr_time) were called on
+  /// each, in order. Materials that decay over the same time delta have their
+  /// new compositions calculated as one batch (see Composition::DecayMany).
+  static void DecayMany(const std::vector<Ptr>& mats, int curr_time);
+
   /// Returns the last time step on which a decay calculation was performed
   /// for the material.  This is not necessarily synonymous with the last time
   /// step the material's Decay function was called.
@@ -153,10 +159,27 @@ class Material: public Resource {
   /// DEPRECATED - use non-const comp() function.
   Composition::Ptr comp() const;
 
+  /// Returns the nuclide composition comp() would return without modifying
+  /// this material, i.e. in lazy decay mode the composition decayed to the
+  /// current time step is returned but not transmuted into the material.
+  Composition::Ptr DecayedComp();
+
+  /// Returns what DecayedComp would return for each material in mats, in
+  /// order. Compositions that decay over the same time delta are calculated
+  /// as one batch (see Composition::DecayMany).
+  static std::vector<Composition::Ptr> DecayedComps(
+      const std::vector<Ptr>& mats);
+
  protected:
   Material(Context* ctx, double quantity, Composition::Ptr c);
 
  private:
+  /// Determines whether a call to Decay(curr_time) would decay this material.
+  /// If so, returns true and sets curr_time (if negative) to the current
+  /// simulation time, dt to the decay time delta, and secs_per_timestep to
+  /// the time step duration.
+  bool DecayStep(int* curr_time, int* dt, uint64_t* secs_per_timestep);
+
   Context* ctx_;
   double qty_;
   Composition::Ptr comp_;
@@ -0,0 +1,66 @@
+#ifndef CYCLUS_SRC_PARALLEL_H_
+#define CYCLUS_SRC_PARALLEL_H_
+
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace cyclus {
+
+/// Calls f(i, thread) for every i in [0, n), distributing the indices over up
+/// to nthreads threads (the calling thread included). thread is the index in
+/// [0, nthreads) of the thread making the call and can be used to address
+/// per-thread scratch data. Indices are handed out dynamically, so f must not
+/// depend on the order in which they are visited. If nthreads < 2 or n < 2, f
+/// is simply called in order on the calling thread with thread == 0. If any
+/// call throws, the remaining indices are skipped and the first exception is
+/// rethrown on the calling thread once all threads have joined.
+template <class F>
+void ParallelFor(int n, int nthreads, F f) {
+  nthreads = std::min(nthreads, n);
+  if (nthreads < 2) {
+    for (int i = 0; i < n; ++i) {
+      f(i, 0);
+    }
+    return;
+  }
+
+  std::atomic<int> next(0);
+  std::exception_ptr err;
+  std::mutex err_mutex;
+  auto work = [&](int thread) {
+    int i;
+    while ((i = next++) < n) {
+      try {
+        f(i, thread);
+      } catch (...) {
+        std::lock_guard<std::mutex> lock(err_mutex);
+        if (!err) {
+          err = std::current_exception();
+        }
+        next = n;
+      }
+    }
+  };
+
+  std::vector<std::thread> workers;
+  workers.reserve(nthreads - 1);
+  for (int t = 1; t < nthreads; ++t) {
+    workers.push_back(std::thread(work, t));
+  }
+  work(0);
+  for (int t = 0; t < workers.size(); ++t) {
+    workers[t].join();
+  }
+
+  if (err) {
+    std::rethrow_exception(err);
+  }
+}
+
+}  // namespace cyclus
+
+#endif  // CYCLUS_SRC_PARALLEL_H_
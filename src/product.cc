@@ -1,5 +1,7 @@
 #include "product.h"
 
+#include <mutex>
+
 #include "error.h"
 #include "logger.h"
 
@@ -10,15 +12,23 @@ const ResourceType Product::kType = "Product";
 std::map<std::string, int> Product::qualids_;
 int Product::next_qualid_ = 1;
 
+namespace {
+// guards qualids_, products are created by traders on several threads
+std::mutex qualids_mtx;
+}  // namespace
+
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 Product::Ptr Product::Create(Agent* creator, double quantity,
                              std::string quality) {
-  if (qualids_.count(quality) == 0) {
-    qualids_[quality] = next_qualid_++;
-    creator->context()->NewDatum("Products")
-        ->AddVal("QualId", qualids_[quality])
-        ->AddVal("Quality", quality)
-        ->Record();
+  {
+    std::lock_guard<std::mutex> lock(qualids_mtx);
+    if (qualids_.count(quality) == 0) {
+      qualids_[quality] = next_qualid_++;
+      creator->context()->NewDatum("Products")
+          ->AddVal("QualId", qualids_[quality])
+          ->AddVal("Quality", quality)
+          ->Record();
+    }
   }
 
   // the next lines must come after qual id setting
@@ -35,6 +45,12 @@ Product::Ptr Product::CreateUntracked(double quantity,
   return r;
 }
 
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+int Product::qual_id() const {
+  std::lock_guard<std::mutex> lock(qualids_mtx);
+  return qualids_[quality_];
+}
+
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 Resource::Ptr Product::Clone() const {
   Product* g = new Product(*this);
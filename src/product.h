@@ -35,9 +35,7 @@ class Product : public Resource {
   static Ptr CreateUntracked(double quantity, std::string quality);
 
   /// Returns 0 (for now).
-  virtual int qual_id() const {
-    return qualids_[quality_];
-  }
+  virtual int qual_id() const;
 
   /// Returns Product::kType.
   virtual const ResourceType type() const {
@@ -2,7 +2,10 @@
 
 #include <sstream>
 
+#include "CoinPackedMatrix.hpp"
+
 #include "context.h"
+#include "cyc_limits.h"
 #include "prog_translator.h"
 #include "greedy_solver.h"
 #include "solver_factory.h"
@@ -20,6 +23,8 @@ ProgSolver::ProgSolver(std::string solver_t)
       tmax_(ProgSolver::kDefaultTimeout),
       verbose_(false),
       mps_(false),
+      warm_start_(false),
+      basis_(new Basis()),
       ExchangeSolver(false) {}
 
 ProgSolver::ProgSolver(std::string solver_t, bool exclusive_orders)
@@ -27,6 +32,8 @@ ProgSolver::ProgSolver(std::string solver_t, bool exclusive_orders)
       tmax_(ProgSolver::kDefaultTimeout),
       verbose_(false),
       mps_(false),
+      warm_start_(false),
+      basis_(new Basis()),
       ExchangeSolver(exclusive_orders) {}
 
 ProgSolver::ProgSolver(std::string solver_t, double tmax)
@@ -34,6 +41,8 @@ ProgSolver::ProgSolver(std::string solver_t, double tmax)
       tmax_(tmax),
       verbose_(false),
       mps_(false),
+      warm_start_(false),
+      basis_(new Basis()),
       ExchangeSolver(false) {}
 
 ProgSolver::ProgSolver(std::string solver_t, double tmax, bool exclusive_orders,
@@ -42,13 +51,117 @@ ProgSolver::ProgSolver(std::string solver_t, double tmax, bool exclusive_orders,
       tmax_(tmax),
       verbose_(verbose),
       mps_(mps),
+      warm_start_(false),
+      basis_(new Basis()),
       ExchangeSolver(exclusive_orders) {}
 
 ProgSolver::~ProgSolver() {}
 
+ExchangeSolver* ProgSolver::Clone() const {
+  ProgSolver* s = new ProgSolver(solver_t_, tmax_, exclusive_orders_, verbose_,
+                                 mps_);
+  s->warm_start(warm_start_);
+  s->basis_ = basis_;
+  return s;
+}
+
+std::vector<ProgColKey> ProgSolver::ColKeys(ExchangeGraph* g) {
+  std::vector<ProgColKey> keys;
+  std::map<ProgColKey, int> counts;
+
+  std::vector<Arc>& arcs = g->arcs();
+  for (int i = 0; i != arcs.size(); i++) {
+    ExchangeNode::Ptr u = arcs[i].unode();
+    ProgColKey k(u->agent_id, arcs[i].vnode()->agent_id, u->commod, 0);
+    k.n = counts[k]++;
+    keys.push_back(k);
+  }
+
+  std::vector<RequestGroup::Ptr>& rgs = g->request_groups();
+  for (int i = 0; i != rgs.size(); i++) {
+    if (!rgs[i]->HasArcs())
+      continue;
+    ProgColKey k(rgs[i]->nodes()[0]->agent_id, -1, "", 0);
+    k.n = counts[k]++;
+    keys.push_back(k);
+  }
+  return keys;
+}
+
+void ProgSolver::WarmStart(const std::vector<ProgColKey>& keys) {
+  int ncols = iface_->getNumCols();
+  int nrows = iface_->getNumRows();
+  std::lock_guard<std::mutex> lock(basis_->mtx);
+  std::map<ProgColKey, CoinWarmStartBasis::Status>& status = basis_->status;
+  if (status.empty() || keys.size() != ncols)
+    return;
+
+  // start from the slack basis, then swap each previously basic column in for
+  // the slack of a row it appears in whose slack is still basic. New columns
+  // start at their lower bound.
+  CoinWarmStartBasis basis;
+  basis.setSize(ncols, nrows);
+  const double* row_ubs = iface_->getRowUpper();
+  const double* col_ubs = iface_->getColUpper();
+  double inf = iface_->getInfinity();
+  for (int i = 0; i != nrows; i++) {
+    basis.setArtifStatus(i, CoinWarmStartBasis::basic);
+  }
+
+  const CoinPackedMatrix* m = iface_->getMatrixByCol();
+  const CoinBigIndex* starts = m->getVectorStarts();
+  const int* lens = m->getVectorLengths();
+  const int* rows = m->getIndices();
+  for (int i = 0; i != ncols; i++) {
+    std::map<ProgColKey, CoinWarmStartBasis::Status>::iterator it =
+        status.find(keys[i]);
+    if (it == status.end() || it->second != CoinWarmStartBasis::basic) {
+      bool upper = it != status.end() &&
+                   it->second == CoinWarmStartBasis::atUpperBound &&
+                   col_ubs[i] < inf;
+      basis.setStructStatus(i, upper ? CoinWarmStartBasis::atUpperBound :
+                            CoinWarmStartBasis::atLowerBound);
+      continue;
+    }
+    basis.setStructStatus(i, CoinWarmStartBasis::atLowerBound);
+    for (CoinBigIndex j = starts[i]; j != starts[i] + lens[i]; j++) {
+      int r = rows[j];
+      if (basis.getArtifStatus(r) == CoinWarmStartBasis::basic) {
+        basis.setArtifStatus(r, row_ubs[r] < inf ?
+                             CoinWarmStartBasis::atUpperBound :
+                             CoinWarmStartBasis::atLowerBound);
+        basis.setStructStatus(i, CoinWarmStartBasis::basic);
+        break;
+      }
+    }
+  }
+  iface_->setWarmStart(&basis);
+}
+
+void ProgSolver::SaveBasis(const std::vector<ProgColKey>& keys) {
+  // only the columns of this solution are updated, those of other components
+  // of the graph are kept
+  const double* sol = iface_->getColSolution();
+  const double* lbs = iface_->getColLower();
+  const double* ubs = iface_->getColUpper();
+  std::lock_guard<std::mutex> lock(basis_->mtx);
+  std::map<ProgColKey, CoinWarmStartBasis::Status>& status = basis_->status;
+  for (int i = 0; i != keys.size(); i++) {
+    if (sol[i] <= lbs[i] + eps()) {
+      status.erase(keys[i]);
+    } else if (sol[i] >= ubs[i] - eps()) {
+      status[keys[i]] = CoinWarmStartBasis::atUpperBound;
+    } else {
+      status[keys[i]] = CoinWarmStartBasis::basic;
+    }
+  }
+}
+
 void ProgSolver::WriteMPS() {
   std::stringstream ss;
   ss << "exchng_" << sim_ctx_->time();
+  if (component_ >= 0)
+    ss << "_" << component_;
   iface_->writeMps(ss.str().c_str());
 }
 
@@ -65,6 +178,11 @@ double ProgSolver::SolveGraph() {
     double pseudo_cost = PseudoCost(); // from ExchangeSolver API
     ProgTranslator xlator(graph_, iface_, exclusive_orders_, pseudo_cost);
     xlator.ToProg();
+    std::vector<ProgColKey> keys;
+    if (warm_start_) {
+      keys = ColKeys(graph_);
+      WarmStart(keys);
+    }
     if (mps_)
       WriteMPS();
 
@@ -83,6 +201,8 @@ double ProgSolver::SolveGraph() {
 
     // solve and back translate
     SolveProg(iface_, greedy_obj, verbose_);
+    if (warm_start_)
+      SaveBasis(keys);
 
     xlator.FromProg();
   } catch(...) {
@@ -3,8 +3,14 @@
 #include "platform.h"
 #if CYCLUS_HAS_COIN
 
+#include <map>
+#include <mutex>
 #include <string>
+#include <vector>
 
+#include <boost/shared_ptr.hpp>
+
+#include "CoinWarmStartBasis.hpp"
 #include "OsiSolverInterface.hpp"
 
 #include "exchange_graph.h"
@@ -14,8 +20,41 @@ namespace cyclus {
 
 class ExchangeGraph;
 
+/// @brief identifies a column of the translated program across time steps.
+/// Arcs are keyed by their requesting and bidding agents, the requested
+/// commodity, and the number of preceding arcs with the same agents and
+/// commodity. The faux arc of a request group is keyed by the requesting agent
+/// of the group's first node, a bidder id of -1, and the number of preceding
+/// groups of that agent.
+struct ProgColKey {
+  ProgColKey(int req, int bid, std::string commod, int n)
+      : req(req), bid(bid), commod(commod), n(n) {}
+
+  inline bool operator<(const ProgColKey& rhs) const {
+    if (req != rhs.req)
+      return req < rhs.req;
+    if (bid != rhs.bid)
+      return bid < rhs.bid;
+    if (commod != rhs.commod)
+      return commod < rhs.commod;
+    return n < rhs.n;
+  }
+
+  int req;
+  int bid;
+  std::string commod;
+  int n;
+};
+
 /// @brief The ProgSolver provides the implementation for a mathematical
 /// programming solution to a resource exchange graph.
+///
+/// If warm starting is enabled, the solver remembers the status of each column
+/// in the previous solution and starts the next solve from the equivalent
+/// basis of the new program. Columns are matched between solves with
+/// ProgColKeys, so this pays off when the exchange changes little between
+/// time steps. When the components of a graph are solved separately, each
+/// component's solution updates the statuses of its own columns.
 class ProgSolver: public ExchangeSolver {
  public:
   static const int kDefaultTimeout = 5 * 60; // 5 * 60 s/min == 5 minutes
@@ -35,6 +74,23 @@ class ProgSolver: public ExchangeSolver {
   /// @}
   virtual ~ProgSolver();
 
+  /// @brief a new ProgSolver with the same configuration. The clone shares
+  /// this solver's remembered basis, so that the components it solves warm
+  /// start from and update the same column statuses.
+  virtual ExchangeSolver* Clone() const;
+
+  /// whether to warm start each solve from the previous solution, default
+  /// false
+  /// @{
+  inline void warm_start(bool w) { warm_start_ = w; }
+  inline bool warm_start() const { return warm_start_; }
+  /// @}
+
+  /// @brief the column keys of the program translated from a graph, in column
+  /// order. Arc columns come first, followed by one faux arc column per request
+  /// group with arcs.
+  static std::vector<ProgColKey> ColKeys(ExchangeGraph* g);
+
  protected:
   /// @brief the ProgSolver solves an ExchangeGraph...
   virtual double SolveGraph();
@@ -42,10 +98,26 @@ class ProgSolver: public ExchangeSolver {
  private:
   void WriteMPS();
 
+  /// @brief sets a warm start basis on iface_ built from the column statuses
+  /// of the last solution
+  void WarmStart(const std::vector<ProgColKey>& keys);
+
+  /// @brief remembers the column statuses of the current solution. Columns
+  /// at their lower bound, the status of new columns, are forgotten.
+  void SaveBasis(const std::vector<ProgColKey>& keys);
+
+  /// @brief column statuses of previous solutions, shared by a solver and its
+  /// clones
+  struct Basis {
+    std::mutex mtx;
+    std::map<ProgColKey, CoinWarmStartBasis::Status> status;
+  };
+
   std::string solver_t_;
   double tmax_;
-  bool verbose_, mps_;
+  bool verbose_, mps_, warm_start_;
   OsiSolverInterface* iface_;
+  boost::shared_ptr<Basis> basis_;
 };
 
 }  // namespace cyclus
@@ -78,16 +78,17 @@ void ProgTranslator::Translate() {
   int n_cols = g_->arcs().size() + nfalse;
   ctx_.m.setDimensions(0, n_cols);
 
+  // supply groups follow the request groups in the flat graph
+  FlatExchangeGraph flat(*g_);
   bool request;
-  std::vector<ExchangeNodeGroup::Ptr>& sgs = g_->supply_groups();
-  for (int i = 0; i != sgs.size(); i++) {
+  for (int i = flat.nreq; i != flat.groups.size(); i++) {
     request = false;
-    XlateGrp_(sgs[i].get(), request);
+    XlateGrp_(flat, i, request);
   }
 
-  for (int i = 0; i != rgs.size(); i++) {
+  for (int i = 0; i != flat.nreq; i++) {
     request = true;
-    XlateGrp_(rgs[i].get(), request);
+    XlateGrp_(flat, i, request);
   }
 
   // add each false arc
@@ -114,7 +115,7 @@ void ProgTranslator::Populate() {
     for (int i = 0; i != arcs.size(); i++) {
       Arc& a = arcs[i];
       if (a.exclusive()) {
-        iface_->setInteger(g_->arc_ids()[a]);
+        iface_->setInteger(i);
       }
     }
   }
@@ -126,7 +127,10 @@ void ProgTranslator::ToProg() {
   Populate();
 }
 
-void ProgTranslator::XlateGrp_(ExchangeNodeGroup* grp, bool request) {
+void ProgTranslator::XlateGrp_(const FlatExchangeGraph& g, int grp_id,
+                               bool request) {
+  ExchangeNodeGroup* grp = g.groups[grp_id];
+  std::vector<Arc>& arcs = g_->arcs();
   double inf = iface_->getInfinity();
   std::vector<double>& caps = grp->capacities();
 
@@ -135,23 +139,21 @@ void ProgTranslator::XlateGrp_(ExchangeNodeGroup* grp, bool request) {
   
   std::vector<CoinPackedVector> cap_rows;
   std::vector<CoinPackedVector> excl_rows;
+  std::vector<double> excl_ubs;
   for (int i = 0; i != caps.size(); i++) {
     cap_rows.push_back(CoinPackedVector());
   }
 
-  std::vector<ExchangeNode::Ptr>& nodes = grp->nodes();
-  for (int i = 0; i != nodes.size(); i++) {
-    std::map<Arc, std::vector<double> >& ucap_map = nodes[i]->unit_capacities;
-    std::map<Arc, std::vector<double> >::iterator cap_it;
-
+  for (int n = g.group_start[grp_id]; n != g.group_start[grp_id + 1]; n++) {
     // add each arc
-    for (cap_it = ucap_map.begin(); cap_it != ucap_map.end(); ++cap_it) {
-      const Arc& a = cap_it->first;
-      std::vector<double>& ucaps = cap_it->second;
-      int arc_id = g_->arc_ids()[a];
+    for (int k = g.adj_start[n]; k != g.adj_start[n + 1]; k++) {
+      int arc_id = g.adj_arcs[k];
+      const Arc& a = arcs[arc_id];
+      bool unode = g.arc_u[arc_id] == n;
+      const double* ucaps = g.ucaps(arc_id, unode);
 
       // add each unit capacity coefficient
-      for (int j = 0; j != ucaps.size(); j++) {
+      for (int j = 0; j != g.n_ucaps(arc_id, unode); j++) {
         double coeff = ucaps[j];
         if (excl_ && a.exclusive()) {
           coeff *= a.excl_val();
@@ -164,8 +166,8 @@ void ProgTranslator::XlateGrp_(ExchangeNodeGroup* grp, bool request) {
         CheckPref(a.pref());
         ctx_.obj_coeffs[arc_id] = ExchangeSolver::Cost(a, excl_);
         ctx_.col_lbs[arc_id] = 0;
-        ctx_.col_ubs[arc_id] = (excl_ && a.exclusive()) ? 1 :
-                               std::min(nodes[i]->qty, inf);
+        ctx_.col_ubs[arc_id] = (excl_ && a.exclusive()) ? a.excl_units() :
+                               std::min(g.nodes[n]->qty, inf);
       }
     }
   }
@@ -197,20 +199,26 @@ void ProgTranslator::XlateGrp_(ExchangeNodeGroup* grp, bool request) {
       CoinPackedVector excl_row;
       std::vector<ExchangeNode::Ptr>& nodes = exngs[i];
       for (int j = 0; j != nodes.size(); j++) {
-        std::vector<Arc>& arcs = g_->node_arc_map()[nodes[j]];
-        for (int k = 0; k != arcs.size(); k++) {
-          excl_row.insert(g_->arc_ids()[arcs[k]], 1.0);
+        int n = g.NodeId(nodes[j].get());
+        if (n < 0) {
+          continue;
+        }
+        for (int k = g.adj_start[n]; k != g.adj_start[n + 1]; k++) {
+          excl_row.insert(g.adj_arcs[k], 1.0);
         }
       }
       if (excl_row.getNumElements() > 0) {
         excl_rows.push_back(excl_row);
+        // the nodes of a group share one offer, and so its multiplicity
+        // (ExchangeNodeGroup::AddExclGroup checks that they agree)
+        excl_ubs.push_back(nodes[0]->multiplicity);
       }
     }
 
     // add all exclusive rows
     for (int i = 0; i != excl_rows.size(); i++) {
       ctx_.row_lbs.push_back(0.0);
-      ctx_.row_ubs.push_back(1.0);
+      ctx_.row_ubs.push_back(excl_ubs[i]);
       ctx_.m.appendRow(excl_rows[i]);
     }
   }
@@ -221,7 +229,7 @@ void ProgTranslator::FromProg() {
   std::vector<Arc>& arcs = g_->arcs();
   double flow;
   for (int i = 0; i < arcs.size(); i++) {
-    Arc& a = g_->arc_by_id().at(i);
+    Arc& a = arcs[i];
     flow = sol[i];
     flow = (excl_ && a.exclusive()) ? flow * a.excl_val() : flow;
     if (flow > cyclus::eps()) {
@@ -12,7 +12,7 @@ class OsiSolverInterface;
 namespace cyclus {
 
 class ExchangeGraph;
-class ExchangeNodeGroup;
+struct FlatExchangeGraph;
 
 /// @brief struct to hold all problem instance state
 struct ProgTranslatorContext {
@@ -47,7 +47,8 @@ class ProgTranslator {
   ///
   /// @param g the exchange graph
   /// @param iface the solver interface
-  /// @param exclusive whether or not to include binary-valued arcs
+  /// @param exclusive whether or not to include integer-valued arcs (binary,
+  /// or general integers for the arcs of nodes with a multiplicity)
   /// @param pseudo_cost the cost to use for faux arcs
   ProgTranslator(ExchangeGraph* g, OsiSolverInterface* iface);
   ProgTranslator(ExchangeGraph* g, OsiSolverInterface* iface, bool exclusive);
@@ -79,9 +80,10 @@ class ProgTranslator {
   void CheckPref(double pref);
 
   /// perform all translation for a node group
-  /// @param grp a pointer to the node group
+  /// @param g the flat view of the exchange graph
+  /// @param grp the id of the node group in g
   /// @param req a boolean flag, true if grp is a request group
-  void XlateGrp_(ExchangeNodeGroup* grp, bool req);
+  void XlateGrp_(const FlatExchangeGraph& g, int grp, bool req);
 
   ExchangeGraph* g_;
   OsiSolverInterface* iface_;
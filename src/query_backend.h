@@ -1,10 +1,13 @@
 #ifndef CYCLUS_SRC_QUERY_BACKEND_H_
 #define CYCLUS_SRC_QUERY_BACKEND_H_
 
+#include <algorithm>
 #include <climits>
 #include <list>
 #include <map>
 #include <set>
+#include <boost/shared_ptr.hpp>
+#include <boost/uuid/uuid.hpp>
 #include <boost/version.hpp>
 
 #if BOOST_VERSION / 100 % 1000 <= 67
@@ -406,6 +409,25 @@ class Cond {
 
 typedef std::vector<boost::spirit::hold_any> QueryRow;
 
+/// Returns the index in fields of each of cols.  Throws a ValueError if cols
+/// is empty and a KeyError if one of cols isn't in fields.
+inline std::vector<int> FieldIndexes(const std::vector<std::string>& fields,
+                                     const std::vector<std::string>& cols) {
+  if (cols.empty()) {
+    throw ValueError("at least one field must be selected");
+  }
+  std::vector<int> idx;
+  for (int k = 0; k < cols.size(); ++k) {
+    std::vector<std::string>::const_iterator it =
+        std::find(fields.begin(), fields.end(), cols[k]);
+    if (it == fields.end()) {
+      throw KeyError("query result has no such field " + cols[k]);
+    }
+    idx.push_back(it - fields.begin());
+  }
+  return idx;
+}
+
 /// Meta data and results of a query.
 class QueryResult {
  public:
@@ -424,6 +446,25 @@ class QueryResult {
     rows.clear();
   }
 
+  /// Keeps only the named fields, in the given order.  Throws a ValueError if
+  /// cols is empty and a KeyError if a field doesn't exist.
+  void Project(const std::vector<std::string>& cols) {
+    std::vector<int> idx = FieldIndexes(fields, cols);
+    std::vector<DbTypes> ptypes;
+    for (int k = 0; k < idx.size(); ++k) {
+      ptypes.push_back(types[idx[k]]);
+    }
+    for (int i = 0; i < rows.size(); ++i) {
+      QueryRow row(idx.size());
+      for (int k = 0; k < idx.size(); ++k) {
+        row[k] = rows[i][idx[k]];
+      }
+      rows[i].swap(row);
+    }
+    fields = cols;
+    types.swap(ptypes);
+  }
+
   /// Convenience method for retrieving a value from a specific row and named
   /// field (column). The caller is responsible for specifying a valid templated
   /// type to cast to. Example use:
@@ -464,6 +505,134 @@ class QueryResult {
   }
 };
 
+/// A single column of a ColumnarResult.  Values are stored contiguously in a
+/// buffer chosen by the column type: INT and BOOL columns in ints, DOUBLE and
+/// FLOAT columns in doubles.  STRING, VL_STRING and UUID columns are
+/// dictionary encoded - codes holds one index per row into strs or uuids
+/// respectively, which hold each distinct value once.  Columns of all other
+/// types keep one hold_any per row in vals.
+class QueryColumn {
+ public:
+  QueryColumn() : type(INT) {}
+  QueryColumn(std::string field, DbTypes type) : field(field), type(type) {}
+
+  /// name of the column
+  std::string field;
+
+  /// type of the column
+  DbTypes type;
+
+  std::vector<int> ints;
+  std::vector<double> doubles;
+  std::vector<int> codes;
+  std::vector<std::string> strs;
+  std::vector<boost::uuids::uuid> uuids;
+  std::vector<boost::spirit::hold_any> vals;
+
+  /// Appends v, which must hold a value of the column's type.
+  void Append(const boost::spirit::hold_any& v) {
+    switch (type) {
+      case INT:
+        ints.push_back(v.cast<int>());
+        break;
+      case BOOL:
+        ints.push_back(v.cast<bool>());
+        break;
+      case DOUBLE:
+        doubles.push_back(v.cast<double>());
+        break;
+      case FLOAT:
+        doubles.push_back(v.cast<float>());
+        break;
+      case STRING:  // fallthrough
+      case VL_STRING:
+        AppendStr(v.cast<std::string>());
+        break;
+      case UUID:
+        AppendUuid(v.cast<boost::uuids::uuid>());
+        break;
+      default:
+        vals.push_back(v);
+    }
+  }
+
+  /// Appends s to a STRING or VL_STRING column.
+  void AppendStr(const std::string& s) {
+    std::map<std::string, int>::iterator it = str_codes_.find(s);
+    if (it == str_codes_.end()) {
+      it = str_codes_.insert(std::make_pair(s, (int)strs.size())).first;
+      strs.push_back(s);
+    }
+    codes.push_back(it->second);
+  }
+
+  /// Appends u to a UUID column.
+  void AppendUuid(const boost::uuids::uuid& u) {
+    std::map<boost::uuids::uuid, int>::iterator it = uuid_codes_.find(u);
+    if (it == uuid_codes_.end()) {
+      it = uuid_codes_.insert(std::make_pair(u, (int)uuids.size())).first;
+      uuids.push_back(u);
+    }
+    codes.push_back(it->second);
+  }
+
+ private:
+  std::map<std::string, int> str_codes_;
+  std::map<boost::uuids::uuid, int> uuid_codes_;
+};
+
+/// Meant to represent the same data as a QueryResult, but stored column by
+/// column in typed buffers (see QueryColumn) rather than as rows of hold_any
+/// values.  This is much cheaper to build for large tables and to hand off to
+/// array based analysis tools.
+class ColumnarResult {
+ public:
+  ColumnarResult() : nrows(0) {}
+
+  /// Converts the rows of qr into columns.
+  explicit ColumnarResult(const QueryResult& qr) : nrows(qr.rows.size()) {
+    for (int j = 0; j < qr.fields.size(); ++j) {
+      columns.push_back(QueryColumn(qr.fields[j], qr.types[j]));
+    }
+    for (int i = 0; i < qr.rows.size(); ++i) {
+      for (int j = 0; j < columns.size(); ++j) {
+        columns[j].Append(qr.rows[i][j]);
+      }
+    }
+  }
+
+  /// the columns in the same order as the table's fields
+  std::vector<QueryColumn> columns;
+
+  /// number of rows (i.e. values in each column)
+  int nrows;
+
+  /// Keeps only the named columns, in the given order.  Throws a ValueError
+  /// if cols is empty and a KeyError if a column doesn't exist.
+  void Project(const std::vector<std::string>& cols) {
+    std::vector<std::string> fields;
+    for (int j = 0; j < columns.size(); ++j) {
+      fields.push_back(columns[j].field);
+    }
+    std::vector<int> idx = FieldIndexes(fields, cols);
+    std::vector<QueryColumn> pcols(idx.size());
+    for (int k = 0; k < idx.size(); ++k) {
+      pcols[k] = columns[idx[k]];
+    }
+    columns.swap(pcols);
+  }
+
+  /// Returns the column with the given field name.
+  QueryColumn& column(std::string field) {
+    for (int i = 0; i < columns.size(); ++i) {
+      if (columns[i].field == field) {
+        return columns[i];
+      }
+    }
+    throw KeyError("query result has no such field " + field);
+  }
+};
+
 /// Represents column information.
 struct ColumnInfo {
   ColumnInfo() {};
@@ -478,6 +647,51 @@ struct ColumnInfo {
   std::vector<int> shape;
 };
 
+/// Streams the rows of a query in batches so that large tables can be scanned
+/// without holding the whole result in memory.  Cursors are created by
+/// QueryableBackend::Cursor and must not outlive the backend they came from.
+///
+/// @code
+///
+/// QueryCursor::Ptr c = backend->Cursor("MyTable", NULL);
+/// QueryResult qr;
+/// while (c->Fetch(10000, &qr)) {
+///   for (int i = 0; i < qr.rows.size(); ++i) {
+///     ...
+///   }
+/// }
+///
+/// @endcode
+class QueryCursor {
+ public:
+  typedef boost::shared_ptr<QueryCursor> Ptr;
+
+  virtual ~QueryCursor() {}
+
+  /// Replaces the contents of qr with the query's fields and types and the
+  /// next (at most) n rows.  Returns false once no rows are left.
+  virtual bool Fetch(int n, QueryResult* qr) = 0;
+};
+
+/// A cursor over an already materialized QueryResult.
+class ResultCursor: public QueryCursor {
+ public:
+  explicit ResultCursor(const QueryResult& qr) : qr_(qr), pos_(0) {}
+
+  virtual bool Fetch(int n, QueryResult* qr) {
+    qr->fields = qr_.fields;
+    qr->types = qr_.types;
+    int end = std::min(pos_ + n, (int)qr_.rows.size());
+    qr->rows.assign(qr_.rows.begin() + pos_, qr_.rows.begin() + end);
+    pos_ = end;
+    return !qr->rows.empty();
+  }
+
+ private:
+  QueryResult qr_;
+  int pos_;
+};
+
 /// Interface implemented by backends that support rudimentary querying.
 class QueryableBackend {
  public:
@@ -487,6 +701,58 @@ class QueryableBackend {
   /// conditions.  Conditions are AND'd together.  conds may be NULL.
   virtual QueryResult Query(std::string table, std::vector<Cond>* conds) = 0;
 
+  /// Same as Query, but returns the result as typed columns.  The default
+  /// implementation converts the result of Query, backends can override this
+  /// to fill the columns directly.
+  virtual ColumnarResult QueryColumns(std::string table,
+                                      std::vector<Cond>* conds) {
+    return ColumnarResult(Query(table, conds));
+  }
+
+  /// Same as Query, but returns a cursor that yields the matching rows in
+  /// batches.  The default implementation runs Query and hands out its rows,
+  /// backends should override this to read rows from disk incrementally.
+  virtual QueryCursor::Ptr Cursor(std::string table,
+                                  std::vector<Cond>* conds) {
+    return QueryCursor::Ptr(new ResultCursor(Query(table, conds)));
+  }
+
+  /// Same as Query, but only returns the columns named in cols, in that
+  /// order, or all columns if cols is NULL.  The conditions may refer to any
+  /// column.  The default implementation drops the other columns from the
+  /// result of Query, backends should override this to not read them at all.
+  /// Throws a ValueError if cols is empty and a KeyError if one of cols
+  /// doesn't exist.
+  virtual QueryResult Query(std::string table, std::vector<Cond>* conds,
+                            std::vector<std::string>* cols) {
+    QueryResult qr = Query(table, conds);
+    if (cols != NULL) {
+      qr.Project(*cols);
+    }
+    return qr;
+  }
+
+  /// Same as QueryColumns, but only returns the columns named in cols (see
+  /// Query).
+  virtual ColumnarResult QueryColumns(std::string table,
+                                      std::vector<Cond>* conds,
+                                      std::vector<std::string>* cols) {
+    ColumnarResult cr = QueryColumns(table, conds);
+    if (cols != NULL) {
+      cr.Project(*cols);
+    }
+    return cr;
+  }
+
+  /// Same as Cursor, but only returns the columns named in cols (see Query).
+  virtual QueryCursor::Ptr Cursor(std::string table, std::vector<Cond>* conds,
+                                  std::vector<std::string>* cols) {
+    if (cols == NULL) {
+      return Cursor(table, conds);
+    }
+    return QueryCursor::Ptr(new ResultCursor(Query(table, conds, cols)));
+  }
+
   /// Return a map of column names of the specified table to the associated
   /// database type.
   virtual std::map<std::string, DbTypes> ColumnTypes(std::string table) = 0;
@@ -513,15 +779,36 @@ class CondInjector: public QueryableBackend {
         to_inject_(to_inject) {}
 
   virtual QueryResult Query(std::string table, std::vector<Cond>* conds) {
-    if (conds == NULL) {
-      return b_->Query(table, &to_inject_);
-    }
+    return Query(table, conds, NULL);
+  }
 
-    std::vector<Cond> c = *conds;
-    for (int i = 0; i < to_inject_.size(); ++i) {
-      c.push_back(to_inject_[i]);
-    }
-    return b_->Query(table, &c);
+  virtual ColumnarResult QueryColumns(std::string table,
+                                      std::vector<Cond>* conds) {
+    return QueryColumns(table, conds, NULL);
+  }
+
+  virtual QueryCursor::Ptr Cursor(std::string table,
+                                  std::vector<Cond>* conds) {
+    return Cursor(table, conds, NULL);
+  }
+
+  virtual QueryResult Query(std::string table, std::vector<Cond>* conds,
+                            std::vector<std::string>* cols) {
+    std::vector<Cond> c = Inject(conds);
+    return b_->Query(table, &c, cols);
+  }
+
+  virtual ColumnarResult QueryColumns(std::string table,
+                                      std::vector<Cond>* conds,
+                                      std::vector<std::string>* cols) {
+    std::vector<Cond> c = Inject(conds);
+    return b_->QueryColumns(table, &c, cols);
+  }
+
+  virtual QueryCursor::Ptr Cursor(std::string table, std::vector<Cond>* conds,
+                                  std::vector<std::string>* cols) {
+    std::vector<Cond> c = Inject(conds);
+    return b_->Cursor(table, &c, cols);
   }
 
   virtual std::map<std::string, DbTypes> ColumnTypes(std::string table) {
@@ -535,6 +822,16 @@ class CondInjector: public QueryableBackend {
   virtual std::set<std::string> Tables() { return b_->Tables(); }
 
  private:
+  /// returns conds (which may be NULL) followed by the injected conditions
+  std::vector<Cond> Inject(std::vector<Cond>* conds) {
+    std::vector<Cond> c;
+    if (conds != NULL) {
+      c = *conds;
+    }
+    c.insert(c.end(), to_inject_.begin(), to_inject_.end());
+    return c;
+  }
+
   QueryableBackend* b_;
   std::vector<Cond> to_inject_;
 };
@@ -553,6 +850,32 @@ class PrefixInjector: public QueryableBackend {
     return b_->Query(prefix_ + table, conds);
   }
 
+  virtual ColumnarResult QueryColumns(std::string table,
+                                      std::vector<Cond>* conds) {
+    return b_->QueryColumns(prefix_ + table, conds);
+  }
+
+  virtual QueryCursor::Ptr Cursor(std::string table,
+                                  std::vector<Cond>* conds) {
+    return b_->Cursor(prefix_ + table, conds);
+  }
+
+  virtual QueryResult Query(std::string table, std::vector<Cond>* conds,
+                            std::vector<std::string>* cols) {
+    return b_->Query(prefix_ + table, conds, cols);
+  }
+
+  virtual ColumnarResult QueryColumns(std::string table,
+                                      std::vector<Cond>* conds,
+                                      std::vector<std::string>* cols) {
+    return b_->QueryColumns(prefix_ + table, conds, cols);
+  }
+
+  virtual QueryCursor::Ptr Cursor(std::string table, std::vector<Cond>* conds,
+                                  std::vector<std::string>* cols) {
+    return b_->Cursor(prefix_ + table, conds, cols);
+  }
+
   virtual std::map<std::string, DbTypes> ColumnTypes(std::string table) {
     return b_->ColumnTypes(table);
   }
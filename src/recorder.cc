@@ -10,36 +10,68 @@
 
 namespace cyclus {
 
-Recorder::Recorder() : index_(0), inject_sim_id_(true) {
+Recorder::Recorder()
+    : index_(0),
+      n_open_(0),
+      n_inflight_(0),
+      async_(false),
+      busy_(false),
+      stop_(false),
+      inject_sim_id_(true) {
   uuid_ = boost::uuids::random_generator()();
   set_dump_count(kDefaultDumpCount);
 }
 
-Recorder::Recorder(bool inject_sim_id) : index_(0), inject_sim_id_(inject_sim_id) {
+Recorder::Recorder(bool inject_sim_id)
+    : index_(0),
+      n_open_(0),
+      n_inflight_(0),
+      async_(false),
+      busy_(false),
+      stop_(false),
+      inject_sim_id_(inject_sim_id) {
   uuid_ = boost::uuids::random_generator()();
   set_dump_count(kDefaultDumpCount);
 }
 
-Recorder::Recorder(unsigned int dump_count) : index_(0), inject_sim_id_(true) {
+Recorder::Recorder(unsigned int dump_count)
+    : index_(0),
+      n_open_(0),
+      n_inflight_(0),
+      async_(false),
+      busy_(false),
+      stop_(false),
+      inject_sim_id_(true) {
   uuid_ = boost::uuids::random_generator()();
   set_dump_count(dump_count);
 }
 
-Recorder::Recorder(boost::uuids::uuid simid) : index_(0), uuid_(simid), \
-                                               inject_sim_id_(true) {
+Recorder::Recorder(boost::uuids::uuid simid)
+    : index_(0),
+      n_open_(0),
+      n_inflight_(0),
+      async_(false),
+      busy_(false),
+      stop_(false),
+      uuid_(simid),
+      inject_sim_id_(true) {
   set_dump_count(kDefaultDumpCount);
 }
 
 Recorder::~Recorder() {
+  // backends may fail with any exception, e.g. rethrown from the writer
+  // thread, none of which may escape the destructor
   try {
     Flush();
-  } catch (Error err) {
+  } catch (std::exception& err) {
     CLOG(LEV_ERROR) << "Error in Recorder destructor: " << err.what();
+  } catch (...) {
+    CLOG(LEV_ERROR) << "Unknown error in Recorder destructor";
   }
+  StopWriter();
 
-  for (int i = 0; i < data_.size(); ++i) {
-    delete data_[i];
-  }
+  ResetPool(&data_, 0);
+  ResetPool(&inflight_, 0);
 }
 
 unsigned int Recorder::dump_count() {
@@ -51,22 +83,56 @@ boost::uuids::uuid Recorder::sim_id() {
 }
 
 void Recorder::set_dump_count(unsigned int count) {
-  for (int i = 0; i < data_.size(); ++i) {
-    delete data_[i];
+  std::lock_guard<std::mutex> rec_lock(record_mutex_);
+  std::unique_lock<std::mutex> lock(mutex_);
+  WaitForWriter(lock);
+  ResetPool(&data_, count);
+  ResetPool(&inflight_, async_ ? count : 0);
+  index_ = 0;
+  n_open_ = 0;
+  dump_count_ = count;
+}
+
+void Recorder::ResetPool(DatumList* pool, unsigned int count) {
+  for (int i = 0; i < pool->size(); ++i) {
+    delete (*pool)[i];
   }
-  data_.clear();
-  data_.reserve(count);
+  pool->clear();
+  pool->reserve(count);
   for (int i = 0; i < count; ++i) {
-    Datum* d = new Datum(this, "");
-    if (inject_sim_id_) {
-      d->AddVal("SimId", uuid_);
-    }
-    data_.push_back(d);
+    pool->push_back(NewPoolDatum());
+  }
+}
+
+Datum* Recorder::NewPoolDatum() {
+  Datum* d = new Datum(this, "");
+  if (inject_sim_id_) {
+    d->AddVal("SimId", uuid_);
+  }
+  return d;
+}
+
+void Recorder::set_async(bool x) {
+  if (x == async_) {
+    return;
+  }
+  if (x) {
+    ResetPool(&inflight_, dump_count_);
+    StartWriter();
+  } else {
+    Flush();
+    StopWriter();
+    ResetPool(&inflight_, 0);
   }
-  dump_count_ = count;
 }
 
 Datum* Recorder::NewDatum(std::string title) {
+  std::lock_guard<std::mutex> lock(record_mutex_);
+  if (index_ >= data_.size()) {
+    // the pool is only full while data handed out on other threads are still
+    // being filled, it is passed to the backends once they are all recorded
+    data_.push_back(NewPoolDatum());
+  }
   Datum* d = data_[index_];
   d->title_ = title;
   if (inject_sim_id_) {
@@ -80,16 +146,23 @@ Datum* Recorder::NewDatum(std::string title) {
   }
 
   index_++;
+  n_open_++;
   return d;
 }
 
 void Recorder::AddDatum(Datum* d) {
-  if (index_ >= data_.size()) {
+  std::lock_guard<std::mutex> lock(record_mutex_);
+  n_open_--;
+  if (n_open_ == 0 && index_ >= dump_count_) {
     NotifyBackends();
   }
 }
 
 void Recorder::Flush() {
+  std::lock_guard<std::mutex> rec_lock(record_mutex_);
+  std::unique_lock<std::mutex> lock(mutex_);
+  WaitForWriter(lock);
+  n_open_ = 0;
   if (index_ == 0)
     return;
   DatumList tmp = data_;
@@ -103,20 +176,108 @@ void Recorder::Flush() {
 }
 
 void Recorder::NotifyBackends() {
-  index_ = 0;
+  if (async_) {
+    // hand the full pool to the writer thread and continue recording into
+    // the spare one, blocking only if the previous pool is still in flight.
+    std::unique_lock<std::mutex> lock(mutex_);
+    WaitForWriter(lock);
+    data_.swap(inflight_);
+    n_inflight_ = index_;
+    index_ = 0;
+    busy_ = true;
+    lock.unlock();
+    work_cv_.notify_one();
+    return;
+  }
+
   std::list<RecBackend*>::iterator it;
+  if (index_ < data_.size()) {
+    // the pool grew beyond the dump count at some point
+    DatumList tmp = data_;
+    tmp.resize(index_);
+    index_ = 0;
+    for (it = backs_.begin(); it != backs_.end(); it++) {
+      (*it)->Notify(tmp);
+    }
+    return;
+  }
+
+  index_ = 0;
   for (it = backs_.begin(); it != backs_.end(); it++) {
     (*it)->Notify(data_);
   }
 }
 
 void Recorder::RegisterBackend(RecBackend* b) {
+  std::unique_lock<std::mutex> lock(mutex_);
+  WaitForWriter(lock);
   backs_.push_back(b);
 }
 
 void Recorder::Close() {
   Flush();
+  StopWriter();
+  ResetPool(&inflight_, 0);
   backs_.clear();
 }
 
+void Recorder::StartWriter() {
+  stop_ = false;
+  busy_ = false;
+  async_ = true;
+  writer_ = std::thread(&Recorder::WriteLoop, this);
+}
+
+void Recorder::StopWriter() {
+  if (!writer_.joinable()) {
+    return;
+  }
+  {
+    std::unique_lock<std::mutex> lock(mutex_);
+    idle_cv_.wait(lock, [this] { return !busy_; });
+    stop_ = true;
+  }
+  work_cv_.notify_one();
+  writer_.join();
+  async_ = false;
+}
+
+void Recorder::WaitForWriter(std::unique_lock<std::mutex>& lock) {
+  idle_cv_.wait(lock, [this] { return !busy_; });
+  if (writer_err_) {
+    std::exception_ptr err = writer_err_;
+    writer_err_ = std::exception_ptr();
+    std::rethrow_exception(err);
+  }
+}
+
+void Recorder::WriteLoop() {
+  std::unique_lock<std::mutex> lock(mutex_);
+  while (true) {
+    work_cv_.wait(lock, [this] { return busy_ || stop_; });
+    if (!busy_) {
+      return;
+    }
+
+    DatumList batch = inflight_;
+    batch.resize(n_inflight_);
+    lock.unlock();
+    std::exception_ptr err;
+    try {
+      std::list<RecBackend*>::iterator it;
+      for (it = backs_.begin(); it != backs_.end(); it++) {
+        (*it)->Notify(batch);
+      }
+    } catch (...) {
+      err = std::current_exception();
+    }
+    lock.lock();
+    if (err) {
+      writer_err_ = err;
+    }
+    busy_ = false;
+    idle_cv_.notify_all();
+  }
+}
+
 }  // namespace cyclus
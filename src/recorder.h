@@ -1,8 +1,12 @@
 #ifndef CYCLUS_SRC_RECORDER_H_
 #define CYCLUS_SRC_RECORDER_H_
 
+#include <condition_variable>
+#include <exception>
 #include <list>
+#include <mutex>
 #include <string>
+#include <thread>
 #include <vector>
 #include <boost/uuid/uuid.hpp>
 #include <boost/uuid/uuid_io.hpp>
@@ -42,6 +46,13 @@ static unsigned int const kDefaultDumpCount = 10000;
 /// manager->Close();
 ///
 /// @endcode
+///
+/// In asynchronous mode (see set_async), the recorder keeps two pools of
+/// Datum objects. When the active pool fills up it is handed off to a
+/// dedicated writer thread that notifies the backends, while the simulation
+/// keeps recording into the other pool. At most one full pool is in flight at
+/// a time; recording blocks until the writer has finished with the previous
+/// one. Backends are never called concurrently from more than one thread.
 class Recorder {
   friend class Datum;
 
@@ -79,6 +90,18 @@ class Recorder {
   /// returns the unique id associated with this cyclus simulation.
   boost::uuids::uuid sim_id();
 
+  /// returns whether or not full Datum buffers are written to backends on a
+  /// dedicated writer thread.
+  bool async() { return async_; };
+
+  /// Turns asynchronous writing on or off. Turning it on allocates a second
+  /// pool of dump_count() Datum objects and starts the writer thread; turning
+  /// it off flushes all buffered data and joins the writer thread.
+  ///
+  /// @warning backends registered with an asynchronous recorder receive
+  /// Notify calls from the writer thread.
+  void set_async(bool x);
+
   /// returns whether or not the unique simulation id will be injected.
   bool inject_sim_id() { return inject_sim_id_; };
 
@@ -92,7 +115,9 @@ class Recorder {
     set_dump_count(dump_count_);
   };
  
-  /// Creates a new datum namespaced under the specified title.
+  /// Creates a new datum namespaced under the specified title. Data may be
+  /// created and recorded on several threads at once. The buffered data are
+  /// only passed to the backends when no datum is being filled.
   ///
   /// @warning choose title carefully to not conflict with Datum objects from other
   /// agents. Also note that a static title (e.g. an unchanging string) will
@@ -111,15 +136,55 @@ class Recorder {
   void Flush();
 
   /// Flushes all buffered Datum objects and flushes all registered backends.
-  /// Unregisters all backends and resets.
+  /// Unregisters all backends, stops the writer thread (if any) and resets.
   void Close();
 
  private:
   void NotifyBackends();
   void AddDatum(Datum* d);
 
+  /// Returns a new, empty Datum for the pool.
+  Datum* NewPoolDatum();
+
+  /// Replaces the contents of pool with count fresh Datum objects.
+  void ResetPool(DatumList* pool, unsigned int count);
+
+  /// Starts the writer thread.
+  void StartWriter();
+
+  /// Waits for any in flight buffer to be written and joins the writer thread.
+  void StopWriter();
+
+  /// Blocks until the writer thread is idle. Rethrows any error raised by a
+  /// backend on the writer thread. The lock must be held by the caller.
+  void WaitForWriter(std::unique_lock<std::mutex>& lock);
+
+  /// Main loop of the writer thread.
+  void WriteLoop();
+
   DatumList data_;
   int index_;
+
+  /// Number of data handed out by NewDatum that haven't been recorded yet.
+  int n_open_;
+
+  /// Guards data_, index_ and n_open_ for data recorded on several threads.
+  /// Taken before mutex_.
+  std::mutex record_mutex_;
+
+  /// Datum pool owned by the writer thread while busy_ is true, and the spare
+  /// pool otherwise.
+  DatumList inflight_;
+  int n_inflight_;
+  bool async_;
+  bool busy_;
+  bool stop_;
+  std::exception_ptr writer_err_;
+  std::thread writer_;
+  std::mutex mutex_;
+  std::condition_variable work_cv_;
+  std::condition_variable idle_cv_;
+
   std::list<RecBackend*> backs_;
   unsigned int dump_count_;
   boost::uuids::uuid uuid_;
@@ -1,6 +1,7 @@
 #ifndef CYCLUS_SRC_RESOURCE_H_
 #define CYCLUS_SRC_RESOURCE_H_
 
+#include <atomic>
 #include <string>
 #include <vector>
 #include <boost/shared_ptr.hpp>
@@ -80,8 +81,10 @@ class Resource {
   virtual Ptr ExtractRes(double quantity) = 0;
 
  private:
-  static int nextstate_id_;
-  static int nextobj_id_;
+  // atomic so that resources may be created by traders queried concurrently
+  // during a threaded resource exchange.
+  static std::atomic<int> nextstate_id_;
+  static std::atomic<int> nextobj_id_;
   int state_id_;
   int obj_id_;
 };
@@ -3,13 +3,18 @@
 
 #include <algorithm>
 #include <functional>
+#include <map>
+#include <mutex>
 #include <set>
+#include <utility>
+#include <vector>
 
 #include "bid_portfolio.h"
 #include "context.h"
 #include "exchange_context.h"
 #include "product.h"
 #include "material.h"
+#include "parallel.h"
 #include "request_portfolio.h"
 #include "trader.h"
 #include "trader_management.h"
@@ -33,6 +38,30 @@ inline static void AdjustPrefs(Trader* t, PrefMap<Product>::type& prefs) {
   t->AdjustProductPrefs(prefs);
 }
 
+/// @brief Serializes calls into traders that are not thread safe (see
+/// Trader::ThreadSafeExchange) when exchanges for different resource types
+/// gather requests and bids at the same time.
+inline std::mutex& SerialTraderMutex() {
+  static std::mutex m;
+  return m;
+}
+
+/// @brief The portfolios collected by a ResourceExchange, from which the
+/// exchange of the next time step reuses those of traders that report them
+/// unchanged (see Trader::MatlRequestsUnchanged). Traders are identified by
+/// their manager's id and their address, so that the portfolios of a
+/// decommissioned trader are never given to a new one.
+template <class T>
+struct ExchangeHistory {
+  typedef std::pair<int, Trader*> TraderKey;
+
+  std::map<TraderKey, std::set<typename RequestPortfolio<T>::Ptr> > requests;
+  std::map<TraderKey, std::set<typename BidPortfolio<T>::Ptr> > bids;
+
+  /// @brief the requests for each commodity
+  typename CommodMap<T>::type commod_requests;
+};
+
 /// @class ResourceExchange
 ///
 /// The ResourceExchange class manages the communication for the supply and
@@ -57,13 +86,24 @@ inline static void AdjustPrefs(Trader* t, PrefMap<Product>::type& prefs) {
 /// exchng.AddAllBids();
 /// exchng.AdjustAll();
 /// @endcode
+///
+/// If the number of threads is set above one, requests and bids of traders
+/// that declare themselves thread safe are collected concurrently. Each
+/// trader's portfolios are stored in a slot of their own and merged into the
+/// exchange context in the same (manager id) order used by the serial
+/// exchange, so the resulting context does not depend on thread scheduling.
+///
+/// If given the history of the previous exchange (see prev_history), the
+/// portfolios of traders that report them unchanged are taken from it instead
+/// of querying the traders. The portfolios collected by this exchange are
+/// available from history() for the next one.
 template <class T>
 class ResourceExchange {
  public:
   /// @brief default constructor
   ///
   /// @param ctx the simulation context
-  ResourceExchange(Context* ctx) {
+  ResourceExchange(Context* ctx) : nthreads_(1), prev_(NULL) {
     sim_ctx_ = ctx;
   }
 
@@ -71,33 +111,129 @@ class ResourceExchange {
     return ex_ctx_;
   }
 
+  /// @brief the number of threads used to query traders
+  inline int nthreads() const { return nthreads_; }
+
+  /// @brief sets the number of threads used to query traders, values below
+  /// two query every trader serially
+  inline void nthreads(int n) { nthreads_ = n; }
+
+  /// @brief sets the history of the previous exchange, from which unchanged
+  /// portfolios are reused. It must outlive the calls to AddAllRequests and
+  /// AddAllBids.
+  inline void prev_history(const ExchangeHistory<T>* h) { prev_ = h; }
+
+  /// @brief the portfolios collected by this exchange
+  inline const ExchangeHistory<T>& history() const { return hist_; }
+
   /// @brief queries traders and collects all requests for bids
   void AddAllRequests() {
     InitTraders();
-    std::for_each(
-        traders_.begin(),
-        traders_.end(),
-        std::bind1st(std::mem_fun(&cyclus::ResourceExchange<T>::AddRequests_),
-                     this));
+    if (nthreads_ < 2) {
+      // the exchange of the other resource type may be gathering on another
+      // thread
+      std::lock_guard<std::mutex> lock(SerialTraderMutex());
+      std::for_each(
+          traders_.begin(),
+          traders_.end(),
+          std::bind1st(
+              std::mem_fun(&cyclus::ResourceExchange<T>::AddRequests_),
+              this));
+      hist_.commod_requests = ex_ctx_.commod_requests;
+      return;
+    }
+
+    std::vector<Trader*> traders(traders_.begin(), traders_.end());
+    std::vector<std::set<typename RequestPortfolio<T>::Ptr> >
+        ports(traders.size());
+    QueryAll(traders, [&](int i, int thread) {
+      ports[i] = Requests(traders[i]);
+    });
+
+    typename std::set<typename RequestPortfolio<T>::Ptr>::iterator it;
+    for (int i = 0; i < ports.size(); ++i) {
+      for (it = ports[i].begin(); it != ports[i].end(); ++it) {
+        ex_ctx_.AddRequestPortfolio(*it);
+      }
+      if (!ports[i].empty()) {
+        hist_.requests[Key(traders[i])] = ports[i];
+      }
+    }
+    hist_.commod_requests = ex_ctx_.commod_requests;
   }
 
   /// @brief queries traders and collects all responses to requests for bids
   void AddAllBids() {
     InitTraders();
-    std::for_each(
-        traders_.begin(),
-        traders_.end(),
-        std::bind1st(std::mem_fun(&cyclus::ResourceExchange<T>::AddBids_),
-                     this));
+    if (nthreads_ < 2) {
+      std::lock_guard<std::mutex> lock(SerialTraderMutex());
+      std::for_each(
+          traders_.begin(),
+          traders_.end(),
+          std::bind1st(std::mem_fun(&cyclus::ResourceExchange<T>::AddBids_),
+                       this));
+      return;
+    }
+
+    // traders commonly index the commodity map with operator[], which
+    // inserts missing commodities, so each thread gets its own copy.
+    std::vector<typename CommodMap<T>::type>
+        commods(nthreads_, ex_ctx_.commod_requests);
+    std::vector<Trader*> traders(traders_.begin(), traders_.end());
+    std::vector<std::set<typename BidPortfolio<T>::Ptr> >
+        ports(traders.size());
+    QueryAll(traders, [&](int i, int thread) {
+      ports[i] = Bids(traders[i], commods[thread]);
+    });
+
+    typename std::set<typename BidPortfolio<T>::Ptr>::iterator it;
+    for (int i = 0; i < ports.size(); ++i) {
+      for (it = ports[i].begin(); it != ports[i].end(); ++it) {
+        ex_ctx_.AddBidPortfolio(*it);
+      }
+      if (!ports[i].empty()) {
+        hist_.bids[Key(traders[i])] = ports[i];
+      }
+    }
   }
 
-  /// @brief adjust preferences for requests given bid responses
+  /// @brief adjust preferences for requests given bid responses. With more
+  /// than one thread, the preferences of requesters that are thread safe,
+  /// along with all of their parents (see Agent::ThreadSafePrefs), are
+  /// adjusted concurrently, followed by those of the other requesters.
   void AdjustAll() {
     InitTraders();
     std::set<Trader*> traders = ex_ctx_.requesters;
+    if (nthreads_ < 2) {
+      std::for_each(
+          traders.begin(),
+          traders.end(),
+          std::bind1st(
+              std::mem_fun(&cyclus::ResourceExchange<T>::AdjustPrefs_),
+              this));
+      return;
+    }
+
+    // each requester's map is looked up before the threads start
+    std::vector<Trader*> safe;
+    std::vector<typename PrefMap<T>::type*> safe_prefs;
+    std::vector<Trader*> serial;
+    std::set<Trader*>::iterator it;
+    for (it = traders.begin(); it != traders.end(); ++it) {
+      if (ThreadSafePrefs(*it)) {
+        safe.push_back(*it);
+        safe_prefs.push_back(&ex_ctx_.trader_prefs[*it]);
+      } else {
+        serial.push_back(*it);
+      }
+    }
+
+    ParallelFor(safe.size(), nthreads_, [&](int i, int thread) {
+      AdjustTraderPrefs(safe[i], *safe_prefs[i]);
+    });
     std::for_each(
-        traders.begin(),
-        traders.end(),
+        serial.begin(),
+        serial.end(),
         std::bind1st(
             std::mem_fun(&cyclus::ResourceExchange<T>::AdjustPrefs_),
             this));
@@ -118,29 +254,140 @@ class ResourceExchange {
     }
   }
 
+  /// @brief calls f(i, thread) for each trader index i, concurrently for
+  /// thread safe traders and then serially (with thread 0) for the rest.
+  template <class F>
+  void QueryAll(const std::vector<Trader*>& traders, F f) {
+    std::vector<int> safe;
+    std::vector<int> serial;
+    for (int i = 0; i < traders.size(); ++i) {
+      if (traders[i]->ThreadSafeExchange()) {
+        safe.push_back(i);
+      } else {
+        serial.push_back(i);
+      }
+    }
+
+    ParallelFor(safe.size(), nthreads_, [&](int j, int thread) {
+      f(safe[j], thread);
+    });
+
+    std::lock_guard<std::mutex> lock(SerialTraderMutex());
+    for (int j = 0; j < serial.size(); ++j) {
+      f(serial[j], 0);
+    }
+  }
+
+  static typename ExchangeHistory<T>::TraderKey Key(Trader* t) {
+    return std::make_pair(t->manager()->id(), t);
+  }
+
+  /// @brief the trader's request portfolios of the previous exchange if it
+  /// reports them unchanged, or else the ones it is queried for
+  std::set<typename RequestPortfolio<T>::Ptr> Requests(Trader* t) {
+    if (prev_ != NULL && RequestsUnchanged<T>(t)) {
+      typename std::map<typename ExchangeHistory<T>::TraderKey,
+                        std::set<typename RequestPortfolio<T>::Ptr> >::
+          const_iterator it = prev_->requests.find(Key(t));
+      if (it != prev_->requests.end()) {
+        return it->second;
+      }
+    }
+    return QueryRequests<T>(t);
+  }
+
+  /// @brief the trader's bid portfolios of the previous exchange if it reports
+  /// them unchanged and the requests they respond to are unchanged, or else
+  /// the ones it is queried for
+  std::set<typename BidPortfolio<T>::Ptr> Bids(
+      Trader* t, typename CommodMap<T>::type& commods) {
+    if (prev_ != NULL && BidsUnchanged<T>(t)) {
+      typename std::map<typename ExchangeHistory<T>::TraderKey,
+                        std::set<typename BidPortfolio<T>::Ptr> >::
+          const_iterator it = prev_->bids.find(Key(t));
+      if (it != prev_->bids.end() && SameRequests(it->second)) {
+        return it->second;
+      }
+    }
+    return QueryBids<T>(t, commods);
+  }
+
+  /// @brief whether the requests for every commodity bid on in ports are the
+  /// same as in the previous exchange
+  bool SameRequests(const std::set<typename BidPortfolio<T>::Ptr>& ports) {
+    typedef typename CommodMap<T>::type Commods;
+    std::set<std::string> checked;
+    typename std::set<typename BidPortfolio<T>::Ptr>::const_iterator p;
+    typename std::set<Bid<T>*>::const_iterator b;
+    for (p = ports.begin(); p != ports.end(); ++p) {
+      for (b = (*p)->bids().begin(); b != (*p)->bids().end(); ++b) {
+        const std::string& commod = (*b)->request()->commodity();
+        if (!checked.insert(commod).second) {
+          continue;
+        }
+        typename Commods::const_iterator prev =
+            prev_->commod_requests.find(commod);
+        typename Commods::const_iterator curr =
+            ex_ctx_.commod_requests.find(commod);
+        if (prev == prev_->commod_requests.end() ||
+            curr == ex_ctx_.commod_requests.end() ||
+            prev->second != curr->second) {
+          return false;
+        }
+      }
+    }
+    return true;
+  }
+
   /// @brief queries a given facility agent for
   void AddRequests_(Trader* t) {
-    std::set<typename RequestPortfolio<T>::Ptr> rp = QueryRequests<T>(t);
+    std::set<typename RequestPortfolio<T>::Ptr> rp = Requests(t);
     typename std::set<typename RequestPortfolio<T>::Ptr>::iterator it;
     for (it = rp.begin(); it != rp.end(); ++it) {
       ex_ctx_.AddRequestPortfolio(*it);
     }
+    if (!rp.empty()) {
+      hist_.requests[Key(t)] = rp;
+    }
   }
 
   /// @brief queries a given facility agent for
   void AddBids_(Trader* t) {
     std::set<typename BidPortfolio<T>::Ptr> bp =
-        QueryBids<T>(t, ex_ctx_.commod_requests);
+        Bids(t, ex_ctx_.commod_requests);
     typename std::set<typename BidPortfolio<T>::Ptr>::iterator it;
     for (it = bp.begin(); it != bp.end(); ++it) {
       ex_ctx_.AddBidPortfolio(*it);
     }
+    if (!bp.empty()) {
+      hist_.bids[Key(t)] = bp;
+    }
+  }
+
+  /// @brief whether a trader and all of its manager's parents may adjust
+  /// preferences concurrently with other traders
+  static bool ThreadSafePrefs(Trader* t) {
+    if (!t->ThreadSafeExchange()) {
+      return false;
+    }
+    for (Agent* m = t->manager()->parent(); m != NULL; m = m->parent()) {
+      if (!m->ThreadSafePrefs()) {
+        return false;
+      }
+    }
+    return true;
   }
 
   /// @brief allows a trader and its parents to adjust any preferences in the
   /// system
   void AdjustPrefs_(Trader* t) {
-    typename PrefMap<T>::type& prefs = ex_ctx_.trader_prefs[t];
+    AdjustTraderPrefs(t, ex_ctx_.trader_prefs[t]);
+  }
+
+  /// @brief allows a trader and its parents to adjust the trader's
+  /// preferences, prefs
+  static void AdjustTraderPrefs(Trader* t,
+                                typename PrefMap<T>::type& prefs) {
     AdjustPrefs(t, prefs);
     Agent* m = t->manager()->parent();
     while (m != NULL) {
@@ -167,8 +414,11 @@ class ResourceExchange {
   // exchange functions are called in a much closer to deterministic order.
   std::set<Trader*, trader_compare> traders_;
 
+  int nthreads_;
   Context* sim_ctx_;
   ExchangeContext<T> ex_ctx_;
+  const ExchangeHistory<T>* prev_;
+  ExchangeHistory<T> hist_;
 };
 
 }  // namespace cyclus
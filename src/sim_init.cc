@@ -1,13 +1,22 @@
 #include "sim_init.h"
 
+#include <algorithm>
+#include <list>
+#include <memory>
+
+#include "datum.h"
 #include "greedy_preconditioner.h"
 #include "greedy_solver.h"
 #include "platform.h"
 #include "prog_solver.h"
+#include "rec_backend.h"
 #include "region.h"
 
 namespace cyclus {
 
+// number of rows read at a time when scanning potentially large tables
+static const int kCursorBatch = 10000;
+
 class Dummy : public Region {
  public:
   Dummy(Context* ctx) : Region(ctx) {}
@@ -71,18 +80,184 @@ void SimInit::InitBase(QueryableBackend* b, boost::uuids::uuid simid, int t) {
   rec_->Flush();
 }
 
+namespace {
+// Records all of m's state (kernel, archetype and inventories) to its
+// context's recorder.
+void RecordAgentState(Agent* m) {
+  // call manually without agent impl injected to keep all Agent state in a
+  // single, consolidated db table
+  m->Agent::Snapshot(DbInit(m, true));
+
+  m->Snapshot(DbInit(m));
+  Inventories invs = m->SnapshotInv();
+  Context* ctx = m->context();
+
+  Inventories::iterator it;
+  for (it = invs.begin(); it != invs.end(); ++it) {
+    std::string name = it->first;
+    std::vector<Resource::Ptr> inv = it->second;
+    for (int i = 0; i < inv.size(); ++i) {
+      ctx->NewDatum("AgentStateInventories")
+          ->AddVal("AgentId", m->id())
+          ->AddVal("SimTime", ctx->time())
+          ->AddVal("InventoryName", name)
+          ->AddVal("ResourceId", inv[i]->state_id())
+          ->Record();
+    }
+  }
+}
+
+template <class T>
+bool HashAs(const boost::spirit::hold_any& v, Sha1* hash) {
+  if (v.type() != typeid(T)) {
+    return false;
+  }
+  hash->Update(v.cast<T>());
+  return true;
+}
+
+template <class T>
+bool HashScalar(const boost::spirit::hold_any& v, Sha1* hash) {
+  if (v.type() != typeid(T)) {
+    return false;
+  }
+  const T& x = v.cast<T>();
+  hash->Update(std::string(reinterpret_cast<const char*>(&x), sizeof(T)));
+  return true;
+}
+
+// Adds v to hash. Returns false if v has a type that cannot be hashed, in
+// which case the state it belongs to is always considered changed.
+bool HashVal(const boost::spirit::hold_any& v, Sha1* hash) {
+  return HashScalar<int>(v, hash) ||
+         HashScalar<double>(v, hash) ||
+         HashScalar<float>(v, hash) ||
+         HashScalar<bool>(v, hash) ||
+         HashScalar<boost::uuids::uuid>(v, hash) ||
+         HashAs<std::string>(v, hash) ||
+         HashAs<Blob>(v, hash) ||
+         HashAs<std::vector<int> >(v, hash) ||
+         HashAs<std::vector<double> >(v, hash) ||
+         HashAs<std::vector<std::string> >(v, hash) ||
+         HashAs<std::set<int> >(v, hash) ||
+         HashAs<std::set<std::string> >(v, hash) ||
+         HashAs<std::list<int> >(v, hash) ||
+         HashAs<std::list<std::string> >(v, hash) ||
+         HashAs<std::pair<int, int> >(v, hash) ||
+         HashAs<std::pair<double, double> >(v, hash) ||
+         HashAs<std::map<int, int> >(v, hash) ||
+         HashAs<std::map<int, double> >(v, hash) ||
+         HashAs<std::map<int, std::string> >(v, hash) ||
+         HashAs<std::map<std::string, int> >(v, hash) ||
+         HashAs<std::map<std::string, double> >(v, hash) ||
+         HashAs<std::map<std::string, std::string> >(v, hash) ||
+         HashAs<std::map<std::string, std::vector<double> > >(v, hash) ||
+         HashAs<std::map<std::string, std::map<int, double> > >(v, hash) ||
+         HashAs<std::map<int, std::map<std::string, double> > >(v, hash);
+}
+}  // namespace
+
+// Collects copies of the data recorded while snapshotting an agent so that
+// they can be compared to the agent's previous snapshot before being recorded
+// to the output db.
+class SnapBuffer : public RecBackend {
+ public:
+  SnapBuffer() : rec_(static_cast<unsigned int>(64)) {
+    rec_.inject_sim_id(false);
+    rec_.RegisterBackend(this);
+  }
+
+  virtual ~SnapBuffer() { rec_.Close(); }
+
+  Recorder* recorder() { return &rec_; }
+
+  virtual void Notify(DatumList data) {
+    for (DatumList::iterator it = data.begin(); it != data.end(); ++it) {
+      Datum* d = *it;
+      Row row = {d->title(), d->fields(), d->vals(), d->shapes()};
+      rows_.push_back(row);
+    }
+  }
+
+  virtual std::string Name() { return "SnapBuffer"; }
+
+  virtual void Flush() {}
+
+  virtual void Close() {}
+
+  /// Computes the digest of all buffered data except for the snapshot time.
+  /// Returns false if the data contains values that cannot be hashed.
+  bool Hash(Digest* d) {
+    rec_.Flush();
+    Sha1 hash;
+    for (int i = 0; i < rows_.size(); ++i) {
+      Row& row = rows_[i];
+      hash.Update(row.title);
+      for (int j = 0; j < row.fields.size(); ++j) {
+        if (row.fields[j] == "SimTime") {
+          continue;
+        }
+        hash.Update(row.fields[j]);
+        if (!HashVal(row.vals[j].second, &hash)) {
+          return false;
+        }
+      }
+    }
+    *d = hash.digest();
+    return true;
+  }
+
+  /// Records all buffered data to ctx and clears the buffer.
+  void Replay(Context* ctx) {
+    rec_.Flush();
+    for (int i = 0; i < rows_.size(); ++i) {
+      Row& row = rows_[i];
+      Datum* d = ctx->NewDatum(row.title);
+      for (int j = 0; j < row.fields.size(); ++j) {
+        d->AddVal(row.fields[j], row.vals[j].second, &row.shapes[j]);
+      }
+      d->Record();
+    }
+    rows_.clear();
+  }
+
+  void Clear() {
+    rec_.Flush();
+    rows_.clear();
+  }
+
+ private:
+  struct Row {
+    std::string title;
+    Datum::Fields fields;
+    Datum::Vals vals;
+    Datum::Shapes shapes;
+  };
+
+  std::vector<Row> rows_;
+  Recorder rec_;
+};
+
 void SimInit::Snapshot(Context* ctx) {
   ctx->NewDatum("Snapshots")
      ->AddVal("Time", ctx->time())
      ->Record();
 
   // snapshot all agent internal state
+  std::unique_ptr<SnapBuffer> buf;
+  if (ctx->sim_info().incremental_snapshot) {
+    buf.reset(new SnapBuffer());
+  }
   std::set<Agent*> mlist = ctx->agent_list_;
   std::set<Agent*>::iterator it;
   for (it = mlist.begin(); it != mlist.end(); ++it) {
     Agent* m = *it;
-    if (m->enter_time() != -1) {
-      SimInit::SnapAgent(m);
+    if (m->enter_time() == -1) {
+      continue;
+    } else if (buf != NULL) {
+      SimInit::SnapChangedAgent(m, buf.get());
+    } else {
+      RecordAgentState(m);
     }
   }
 
@@ -100,17 +275,17 @@ void SimInit::Snapshot(Context* ctx) {
   ctx->NewDatum("NextIds")
       ->AddVal("Time", ctx->time())
       ->AddVal("Object", std::string("Composition"))
-      ->AddVal("NextId", Composition::next_id_)
+      ->AddVal("NextId", Composition::next_id_.load())
       ->Record();
   ctx->NewDatum("NextIds")
       ->AddVal("Time", ctx->time())
       ->AddVal("Object", std::string("ResourceState"))
-      ->AddVal("NextId", Resource::nextstate_id_)
+      ->AddVal("NextId", Resource::nextstate_id_.load())
       ->Record();
   ctx->NewDatum("NextIds")
       ->AddVal("Time", ctx->time())
       ->AddVal("Object", std::string("ResourceObj"))
-      ->AddVal("NextId", Resource::nextobj_id_)
+      ->AddVal("NextId", Resource::nextobj_id_.load())
       ->Record();
   ctx->NewDatum("NextIds")
       ->AddVal("Time", ctx->time())
@@ -120,26 +295,40 @@ void SimInit::Snapshot(Context* ctx) {
 }
 
 void SimInit::SnapAgent(Agent* m) {
-  // call manually without agent impl injected to keep all Agent state in a
-  // single, consolidated db table
-  m->Agent::Snapshot(DbInit(m, true));
+  if (m->context()->sim_info().incremental_snapshot) {
+    SnapBuffer buf;
+    SnapChangedAgent(m, &buf);
+  } else {
+    RecordAgentState(m);
+  }
+}
 
-  m->Snapshot(DbInit(m));
-  Inventories invs = m->SnapshotInv();
+void SimInit::SnapChangedAgent(Agent* m, SnapBuffer* buf) {
+  // record the agent's state into the buffer instead of the output db
   Context* ctx = m->context();
+  Recorder* rec = ctx->rec_;
+  ctx->rec_ = buf->recorder();
+  try {
+    RecordAgentState(m);
+  } catch (...) {
+    ctx->rec_ = rec;
+    throw;
+  }
+  ctx->rec_ = rec;
+
+  Digest d;
+  bool hashed = buf->Hash(&d);
+  std::map<int, Digest>::iterator it = ctx->snapshot_digests_.find(m->id());
+  if (hashed && it != ctx->snapshot_digests_.end() && it->second == d) {
+    buf->Clear();
+    return;  // unchanged since the agent's previous snapshot
+  }
 
-  Inventories::iterator it;
-  for (it = invs.begin(); it != invs.end(); ++it) {
-    std::string name = it->first;
-    std::vector<Resource::Ptr> inv = it->second;
-    for (int i = 0; i < inv.size(); ++i) {
-      ctx->NewDatum("AgentStateInventories")
-          ->AddVal("AgentId", m->id())
-          ->AddVal("SimTime", ctx->time())
-          ->AddVal("InventoryName", name)
-          ->AddVal("ResourceId", inv[i]->state_id())
-          ->Record();
-    }
+  buf->Replay(ctx);
+  if (hashed) {
+    ctx->snapshot_digests_[m->id()] = d;
+  } else if (it != ctx->snapshot_digests_.end()) {
+    ctx->snapshot_digests_.erase(it);
   }
 }
 
@@ -168,6 +357,11 @@ void SimInit::LoadInfo() {
   si_.explicit_inventory = qr.GetVal<bool>("RecordInventory");
   si_.explicit_inventory_compact = qr.GetVal<bool>("RecordInventoryCompact");
 
+  try {
+    qr = b_->Query("InfoSnapshot", NULL);
+    si_.incremental_snapshot = qr.GetVal<bool>("Incremental");
+  } catch (std::exception err) {}  // table doesn't exist (okay)
+
   ctx_->InitSim(si_);
 }
 
@@ -246,6 +440,7 @@ ExchangeSolver* SimInit::LoadCoinSolver(bool exclusive,
   ExchangeSolver* solver;
   double timeout;
   bool verbose, mps;
+  bool warm_start = false;
 
   std::string solver_info = "CoinSolverInfo";
   if (0 < tables.count(solver_info)) {
@@ -253,11 +448,18 @@ ExchangeSolver* SimInit::LoadCoinSolver(bool exclusive,
     timeout = qr.GetVal<double>("Timeout");
     verbose = qr.GetVal<bool>("Verbose");
     mps = qr.GetVal<bool>("Mps");
+    // databases written before warm starting was added lack this column
+    if (std::find(qr.fields.begin(), qr.fields.end(), "WarmStart") !=
+        qr.fields.end()) {
+      warm_start = qr.GetVal<bool>("WarmStart");
+    }
   }
 
   // set timeout to default if input value is non-positive
   timeout = timeout <= 0 ? ProgSolver::kDefaultTimeout : timeout;
-  solver = new ProgSolver("cbc", timeout, exclusive, verbose, mps);
+  ProgSolver* prog = new ProgSolver("cbc", timeout, exclusive, verbose, mps);
+  prog->warm_start(warm_start);
+  solver = prog;
   return solver;
 #else
   throw cyclus::Error("Cyclus was not compiled with COIN support, cannot load solver.");
@@ -324,55 +526,150 @@ void SimInit::LoadPrototypes() {
   }
 }
 
+AgentStateCache::AgentStateCache(QueryableBackend* b,
+                                 const std::map<int, int>& snap_times)
+    : b_(b),
+      snap_times_(snap_times),
+      agent_(-1) {
+  std::map<int, int>::const_iterator it;
+  for (it = snap_times.begin(); it != snap_times.end(); ++it) {
+    times_.insert(it->second);
+  }
+  tables_ = b->Tables();
+}
+
+QueryResult AgentStateCache::Query(std::string table,
+                                   std::vector<Cond>* conds) {
+  if ((conds == NULL || conds->empty()) && tables_.count(table) > 0) {
+    Table& tbl = Load(table);
+    if (!tbl.direct) {
+      QueryResult qr = tbl.info;
+      std::map<int, std::vector<QueryRow> >::iterator it =
+          tbl.rows.find(agent_);
+      if (it != tbl.rows.end()) {
+        qr.rows = it->second;
+      }
+      return qr;
+    }
+  }
+
+  std::vector<Cond> c;
+  if (conds != NULL) {
+    c = *conds;
+  }
+  c.push_back(Cond("AgentId", "==", agent_));
+  c.push_back(Cond("SimTime", "==", snap_times_[agent_]));
+  return b_->Query(table, &c);
+}
+
+AgentStateCache::Table& AgentStateCache::Load(std::string table) {
+  std::map<std::string, Table>::iterator cached = cache_.find(table);
+  if (cached != cache_.end()) {
+    return cached->second;
+  }
+
+  Table& tbl = cache_[table];
+  std::map<std::string, DbTypes> types = b_->ColumnTypes(table);
+  if (types.count("AgentId") == 0 || types.count("SimTime") == 0) {
+    tbl.direct = true;
+    return tbl;
+  }
+
+  std::set<int>::iterator t;
+  for (t = times_.begin(); t != times_.end(); ++t) {
+    std::vector<Cond> conds;
+    conds.push_back(Cond("SimTime", "==", *t));
+    QueryCursor::Ptr c = b_->Cursor(table, &conds);
+    QueryResult qr;
+    while (c->Fetch(kCursorBatch, &qr)) {
+      int idcol = std::find(qr.fields.begin(), qr.fields.end(), "AgentId") -
+                  qr.fields.begin();
+      for (int i = 0; i < qr.rows.size(); ++i) {
+        int id = qr.rows[i][idcol].cast<int>();
+        std::map<int, int>::iterator snap = snap_times_.find(id);
+        if (snap != snap_times_.end() && snap->second == *t) {
+          tbl.rows[id].push_back(qr.rows[i]);
+        }
+      }
+      tbl.info.fields = qr.fields;
+      tbl.info.types = qr.types;
+    }
+  }
+  if (tbl.info.fields.empty()) {
+    // no rows at any snapshot time - get the fields from an empty result
+    std::vector<Cond> none(1, Cond("SimTime", "<", 0));
+    tbl.info = b_->Query(table, &none);
+  }
+  return tbl;
+}
+
 void SimInit::LoadInitialAgents() {
   // DO NOT call the agents' Build methods because the agents might modify the
   // state of their children and/or the simulation in ways that are only meant
   // to be done once; remember that we are initializing agents from a
   // simulation that was already started.
 
-  // find all agents that are alive at the current timestep
+  // find all agents that were decommissioned before t_
+  std::set<int> exited;
   std::vector<Cond> conds;
+  conds.push_back(Cond("ExitTime", "<", t_));
+  try {
+    QueryResult qexit = b_->Query("AgentExit", &conds);
+    for (int i = 0; i < qexit.rows.size(); ++i) {
+      exited.insert(qexit.GetVal<int>("AgentId", i));
+    }
+  } catch (std::exception err) {}  // table doesn't exist (okay)
+
+  // find all agents that are alive at the current timestep
+  conds.clear();
   conds.push_back(Cond("EnterTime", "<=", t_));
-  QueryResult qentry = b_->Query("AgentEntry", &conds);
+  QueryCursor::Ptr entries = b_->Cursor("AgentEntry", &conds);
+  QueryResult qentry;
   std::map<int, int> parentmap;  // map<agentid, parentid>
   std::map<int, Agent*> unbuilt;  // map<agentid, agent_ptr>
-  for (int i = 0; i < qentry.rows.size(); ++i) {
-    if (t_ > 0 && qentry.GetVal<int>("EnterTime", i) == t_) {
-      // agent is scheduled to be built already
-      continue;
-    }
-    int id = qentry.GetVal<int>("AgentId", i);
-    std::vector<Cond> conds;
-    conds.push_back(Cond("AgentId", "==", id));
-    conds.push_back(Cond("ExitTime", "<", t_));
-    try {
-      QueryResult qexit = b_->Query("AgentExit", &conds);
-      if (qexit.rows.size() != 0) {
+  std::vector<AgentSpec> specs;
+  std::vector<int> ids;
+  while (entries->Fetch(kCursorBatch, &qentry)) {
+    for (int i = 0; i < qentry.rows.size(); ++i) {
+      if (t_ > 0 && qentry.GetVal<int>("EnterTime", i) == t_) {
+        // agent is scheduled to be built already
+        continue;
+      }
+      int id = qentry.GetVal<int>("AgentId", i);
+      if (exited.count(id) > 0) {
         continue;  // agent was decomissioned before t_ - skip
       }
-    } catch (std::exception err) {}  // table doesn't exist (okay)
-
-    // if the agent wasn't decommissioned before t_ create and init it
 
-    std::string proto = qentry.GetVal<std::string>("Prototype", i);
-    std::string impl = qentry.GetVal<std::string>("Spec", i);
-    AgentSpec spec(impl);
-    Agent* m = DynamicModule::Make(ctx_, spec);
-
-    // agent-kernel init
-    m->prototype_ = proto;
-    m->id_ = id;
-    m->enter_time_ = qentry.GetVal<int>("EnterTime", i);
-    unbuilt[id] = m;
-    parentmap[id] = qentry.GetVal<int>("ParentId", i);
+      // if the agent wasn't decommissioned before t_ create it
+
+      std::string proto = qentry.GetVal<std::string>("Prototype", i);
+      std::string impl = qentry.GetVal<std::string>("Spec", i);
+      AgentSpec spec(impl);
+      Agent* m = DynamicModule::Make(ctx_, spec);
+
+      // agent-kernel init
+      m->prototype_ = proto;
+      m->id_ = id;
+      m->enter_time_ = qentry.GetVal<int>("EnterTime", i);
+      unbuilt[id] = m;
+      parentmap[id] = qentry.GetVal<int>("ParentId", i);
+      snap_times_[id] = t_;
+      specs.push_back(spec);
+      ids.push_back(id);
+    }
+  }
 
-    // agent-custom init
-    conds.pop_back();
-    conds.push_back(Cond("SimTime", "==", t_));
-    CondInjector ci(b_, conds);
-    PrefixInjector pi(&ci, "AgentState");
+  // agent-custom init from the agent's latest snapshot - with incremental
+  // snapshots an unchanged agent has no state recorded at t_ itself.  Each
+  // state table is read once for all agents.
+  LoadSnapshotTimes();
+  AgentStateCache cache(b_, snap_times_);
+  for (int i = 0; i < ids.size(); ++i) {
+    Agent* m = unbuilt[ids[i]];
+    cache.agent(ids[i]);
+    PrefixInjector pi(&cache, "AgentState");
     m->Agent::InitFrom(&pi);
-    pi = PrefixInjector(&ci, "AgentState" + spec.Sanitize());
+    pi = PrefixInjector(&cache, "AgentState" + specs[i].Sanitize());
     m->InitFrom(&pi);
   }
 
@@ -411,17 +708,48 @@ void SimInit::LoadInitialAgents() {
   }
 }
 
+void SimInit::LoadSnapshotTimes() {
+  std::vector<Cond> conds;
+  conds.push_back(Cond("SimTime", "<=", t_));
+  QueryCursor::Ptr c;
+  try {
+    c = b_->Cursor("AgentStateAgent", &conds);
+  } catch (std::exception err) {return;}  // table doesn't exist (okay)
+
+  std::map<int, int> latest;
+  QueryResult qr;
+  while (c->Fetch(kCursorBatch, &qr)) {
+    for (int i = 0; i < qr.rows.size(); ++i) {
+      int id = qr.GetVal<int>("AgentId", i);
+      int t = qr.GetVal<int>("SimTime", i);
+      std::map<int, int>::iterator it = latest.find(id);
+      if (it == latest.end()) {
+        latest[id] = t;
+      } else {
+        it->second = std::max(it->second, t);
+      }
+    }
+  }
+
+  std::map<int, int>::iterator it;
+  for (it = snap_times_.begin(); it != snap_times_.end(); ++it) {
+    if (latest.count(it->first) > 0) {
+      it->second = latest[it->first];
+    }
+  }
+}
+
 void SimInit::LoadInventories() {
+  if (b_->Tables().count("AgentStateInventories") == 0) {
+    return;  // table doesn't exist (okay)
+  }
+
+  AgentStateCache cache(b_, snap_times_);
   std::map<int, Agent*>::iterator it;
   for (it = agents_.begin(); it != agents_.end(); ++it) {
     Agent* m = it->second;
-    std::vector<Cond> conds;
-    conds.push_back(Cond("SimTime", "==", t_));
-    conds.push_back(Cond("AgentId", "==", m->id()));
-    QueryResult qr;
-    try {
-      qr = b_->Query("AgentStateInventories", &conds);
-    } catch (std::exception err) {return;}  // table doesn't exist (okay)
+    cache.agent(m->id());
+    QueryResult qr = cache.Query("AgentStateInventories", NULL);
 
     Inventories invs;
     for (int i = 0; i < qr.rows.size(); ++i) {
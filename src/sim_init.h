@@ -11,6 +11,57 @@
 namespace cyclus {
 
 class Context;
+class SnapBuffer;
+
+/// Serves the rows of agent state tables one agent at a time during
+/// initialization from a database.  Each table is read from the wrapped
+/// backend once when it is first queried, with one query per distinct
+/// snapshot time.  Only the rows from each agent's snapshot are kept, grouped
+/// by AgentId, so that an AgentStateCache with the agent selected stands in
+/// for a CondInjector on AgentId and SimTime.  Queries with conditions and
+/// queries of tables without AgentId and SimTime columns are passed on to the
+/// wrapped backend with the agent's conditions injected.
+class AgentStateCache: public QueryableBackend {
+ public:
+  /// @param b the backend to read from
+  /// @param snap_times the time of each agent's snapshot by agent id
+  AgentStateCache(QueryableBackend* b, const std::map<int, int>& snap_times);
+
+  /// Selects the agent whose rows are returned by queries.
+  void agent(int id) { agent_ = id; }
+
+  virtual QueryResult Query(std::string table, std::vector<Cond>* conds);
+
+  virtual std::map<std::string, DbTypes> ColumnTypes(std::string table) {
+    return b_->ColumnTypes(table);
+  }
+
+  virtual std::list<ColumnInfo> Schema(std::string table) {
+    return b_->Schema(table);
+  }
+
+  virtual std::set<std::string> Tables() { return b_->Tables(); }
+
+ private:
+  /// the fields and types of a cached table and its rows by agent id.  If
+  /// direct is true the table is queried for every agent instead.
+  struct Table {
+    Table() : direct(false) {}
+    bool direct;
+    QueryResult info;
+    std::map<int, std::vector<QueryRow> > rows;
+  };
+
+  /// Returns the cached table, reading it if necessary.
+  Table& Load(std::string table);
+
+  QueryableBackend* b_;
+  std::map<int, int> snap_times_;
+  std::set<int> times_;
+  std::set<std::string> tables_;
+  std::map<std::string, Table> cache_;
+  int agent_;
+};
 
 /// Handles initialization of a simulation from the output database. After
 /// calling Init, Restart, or Branch, the initialized Context, Timer, and
@@ -45,7 +96,10 @@ class SimInit {
               boost::uuids::uuid new_sim_id);
 
   /// Records a snapshot of the current state of the simulation being managed by
-  /// ctx into the simulation's output database.
+  /// ctx into the simulation's output database. If incremental snapshots are
+  /// enabled (see SimInfo::incremental_snapshot), only agents whose state
+  /// differs from their previous snapshot are recorded; Restart loads each
+  /// agent from its latest snapshot.
   static void Snapshot(Context* ctx);
 
   /// Records a snapshot of the agent's current internal state into the
@@ -78,6 +132,14 @@ class SimInit {
  private:
   void InitBase(QueryableBackend* b, boost::uuids::uuid simid, int t);
 
+  /// Records a snapshot of the agent's state via buf only if it differs from
+  /// the agent's previously recorded snapshot.
+  static void SnapChangedAgent(Agent* m, SnapBuffer* buf);
+
+  /// Sets the time of the latest snapshot at or before t_ of each of the
+  /// agents in snap_times_, reading all snapshot times in one pass.
+  void LoadSnapshotTimes();
+
   void LoadInfo();
   void LoadRecipes();
   void LoadSolverInfo();
@@ -99,6 +161,9 @@ class SimInit {
   // std::map<AgentId, Agent*>
   std::map<int, Agent*> agents_;
 
+  // std::map<AgentId, time of the snapshot the agent was loaded from>
+  std::map<int, int> snap_times_;
+
   Context* ctx_;
   Recorder* rec_;
   Timer ti_;
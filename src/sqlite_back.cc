@@ -1,11 +1,14 @@
 #include "sqlite_back.h"
 
+#include <algorithm>
 #include <iomanip>
 #include <sstream>
 
 #include <boost/lexical_cast.hpp>
 #include <boost/uuid/uuid_io.hpp>
 #include <boost/algorithm/string.hpp>
+#include <boost/archive/binary_iarchive.hpp>
+#include <boost/archive/binary_oarchive.hpp>
 #include <boost/archive/tmpdir.hpp>
 #include <boost/archive/xml_iarchive.hpp>
 #include <boost/archive/xml_oarchive.hpp>
@@ -25,6 +28,11 @@
 
 namespace cyclus {
 
+// In bulk mode, up to this many rows are inserted by a single statement
+// (limited by the maximum number of sqlite parameters per statement).
+static const int kBulkRows = 64;
+static const int kMaxBindVars = 999;
+
 std::vector<std::string> split(const std::string& s, char delim) {
   std::vector<std::string> elems;
   std::stringstream ss(s);
@@ -38,14 +46,20 @@ std::vector<std::string> split(const std::string& s, char delim) {
 SqliteBack::~SqliteBack() {
   try {
     Flush();
+    queries_.clear();
+    batch_stmts_.clear();
     db_.close();
   } catch (Error err) {
     CLOG(LEV_ERROR) << "Error in SqliteBack destructor: " << err.what();
   }
 }
 
-SqliteBack::SqliteBack(std::string path) : db_(path) {
+SqliteBack::SqliteBack(std::string path) : db_(path), bulk_(false) {
   path_ = path;
+  index_fields_.insert("SimId");
+  index_fields_.insert("AgentId");
+  index_fields_.insert("Time");
+  index_fields_.insert("ResourceId");
   db_.open();
 
   db_.Execute("PRAGMA synchronous=OFF;");
@@ -70,15 +84,51 @@ SqliteBack::SqliteBack(std::string path) : db_(path) {
 void SqliteBack::Notify(DatumList data) {
   db_.Execute("BEGIN TRANSACTION;");
   try {
-    for (DatumList::iterator it = data.begin(); it != data.end(); ++it) {
-      std::string tbl = (*it)->title();
-      if (tbl_names_.count(tbl) == 0) {
-        CreateTable(*it);
+    // consecutive datums usually share a table, so the statement and schema
+    // lookups are only redone when the title changes.
+    std::string tbl;
+    SqlStatement::Ptr stmt;
+    std::vector<DbTypes>* schema = NULL;
+    int nbatch = 1;
+    DatumList::iterator it = data.begin();
+    while (it != data.end()) {
+      const std::string& title = (*it)->title();
+      if (schema == NULL || title != tbl) {
+        tbl = title;
+        if (tbl_names_.count(tbl) == 0) {
+          CreateTable(*it);
+        }
+        if (stmts_.count(tbl) == 0) {
+          BuildStmt(*it);
+        }
+        stmt = stmts_[tbl];
+        schema = &schemas_[tbl];
+        nbatch = std::min(kBulkRows, kMaxBindVars / (int)schema->size());
+      }
+
+      // in bulk mode, full batches of rows are inserted by one statement
+      DatumList::iterator end = it;
+      int n = 0;
+      while (bulk_ && n < nbatch && end != data.end() &&
+             (*end)->title() == tbl) {
+        ++end;
+        ++n;
       }
-      if (stmts_.count(tbl) == 0) {
-        BuildStmt(*it);
+      if (n > 1 && n == nbatch) {
+        SqlStatement::Ptr& batch = batch_stmts_[tbl];
+        if (batch == NULL) {
+          batch = db_.Prepare(InsertSql(tbl, schema->size(), nbatch));
+        }
+        for (int i = 0; it != end; ++it, i += schema->size()) {
+          BindDatum(*it, batch, *schema, i);
+        }
+        batch->Exec();
+        continue;
       }
-      WriteDatum(*it);
+
+      BindDatum(*it, stmt, *schema, 0);
+      stmt->Exec();
+      ++it;
     }
   } catch (ValueError err) {
     db_.Execute("END TRANSACTION;");
@@ -90,6 +140,52 @@ void SqliteBack::Notify(DatumList data) {
 
 void SqliteBack::Flush() { }
 
+void SqliteBack::Close() {
+  std::set<std::string>::iterator it;
+  for (it = tbl_names_.begin(); it != tbl_names_.end(); ++it) {
+    if (*it != "FieldTypes") {
+      CreateIndexes(*it);
+    }
+  }
+}
+
+void SqliteBack::set_bulk(bool bulk) {
+  if (bulk) {
+    db_.Execute("PRAGMA journal_mode=OFF;");
+    db_.Execute("PRAGMA locking_mode=EXCLUSIVE;");
+    db_.Execute("PRAGMA cache_size=-262144;");  // 256 MiB
+  } else {
+    db_.Execute("PRAGMA journal_mode=MEMORY;");
+    db_.Execute("PRAGMA locking_mode=NORMAL;");
+    db_.Execute("PRAGMA cache_size=-2000;");  // sqlite's default
+  }
+  bulk_ = bulk;
+}
+
+void SqliteBack::index_fields(const std::set<std::string>& fields) {
+  index_fields_ = fields;
+}
+
+void SqliteBack::CreateIndexes(std::string table) {
+  if (index_fields_.empty() || indexed_.count(table) > 0) {
+    return;
+  }
+  indexed_.insert(table);
+  if (db_.readonly()) {
+    // the database is queried as it is
+    return;
+  }
+
+  std::vector<std::string> fields = GetTableInfo(table).fields;
+  for (int i = 0; i < fields.size(); ++i) {
+    if (index_fields_.count(fields[i]) == 0) {
+      continue;
+    }
+    db_.Execute("CREATE INDEX IF NOT EXISTS " + table + "_" + fields[i] +
+                "_idx ON " + table + " (" + fields[i] + ");");
+  }
+}
+
 std::list<ColumnInfo> SqliteBack::Schema(std::string table) {
   std::list<ColumnInfo> schema;
   QueryResult qr = GetTableInfo(table);
@@ -101,23 +197,166 @@ std::list<ColumnInfo> SqliteBack::Schema(std::string table) {
 }
 
 QueryResult SqliteBack::Query(std::string table, std::vector<Cond>* conds) {
-  QueryResult q = GetTableInfo(table);
+  return Query(table, conds, NULL);
+}
+
+QueryResult SqliteBack::Query(std::string table, std::vector<Cond>* conds,
+                              std::vector<std::string>* cols) {
+  QueryResult q = GetTableInfo(table, cols);
+  std::string sql;
+  SqlStatement::Ptr stmt = Select(table, conds, cols, &sql);
+
+  try {
+    for (int i = 0; stmt->Step(); ++i) {
+      QueryRow r;
+      for (int j = 0; j < q.fields.size(); ++j) {
+        r.push_back(ColAsVal(stmt, j, q.types[j]));
+      }
+      q.rows.push_back(r);
+    }
+    stmt->Reset();
+  } catch (...) {
+    // a failed statement can't be reset for reuse
+    queries_.erase(sql);
+    throw;
+  }
+  return q;
+}
+
+/// Steps a statement of its own only as far as the rows fetched so far.
+class SqliteCursor: public QueryCursor {
+ public:
+  SqliteCursor(SqliteBack* back, const QueryResult& info,
+               SqlStatement::Ptr stmt)
+      : back_(back), info_(info), stmt_(stmt) {}
+
+  virtual bool Fetch(int n, QueryResult* qr) {
+    qr->fields = info_.fields;
+    qr->types = info_.types;
+    qr->rows.clear();
+    while (stmt_ != NULL && qr->rows.size() < n) {
+      if (!stmt_->Step()) {
+        stmt_.reset();  // finalizes the statement
+        break;
+      }
+      QueryRow r;
+      r.reserve(info_.fields.size());
+      for (int j = 0; j < info_.fields.size(); ++j) {
+        r.push_back(back_->ColAsVal(stmt_, j, info_.types[j]));
+      }
+      qr->rows.push_back(r);
+    }
+    return !qr->rows.empty();
+  }
+
+ private:
+  SqliteBack* back_;
+  QueryResult info_;
+  SqlStatement::Ptr stmt_;
+};
+
+QueryCursor::Ptr SqliteBack::Cursor(std::string table,
+                                    std::vector<Cond>* conds) {
+  return Cursor(table, conds, NULL);
+}
+
+QueryCursor::Ptr SqliteBack::Cursor(std::string table,
+                                    std::vector<Cond>* conds,
+                                    std::vector<std::string>* cols) {
+  QueryResult info = GetTableInfo(table, cols);
+  std::string sql;
+  SqlStatement::Ptr stmt = Select(table, conds, cols, &sql, false);
+  return QueryCursor::Ptr(new SqliteCursor(this, info, stmt));
+}
+
+ColumnarResult SqliteBack::QueryColumns(std::string table,
+                                        std::vector<Cond>* conds) {
+  return QueryColumns(table, conds, NULL);
+}
+
+ColumnarResult SqliteBack::QueryColumns(std::string table,
+                                        std::vector<Cond>* conds,
+                                        std::vector<std::string>* cols) {
+  QueryResult info = GetTableInfo(table, cols);
+  std::string sql;
+  SqlStatement::Ptr stmt = Select(table, conds, cols, &sql);
+
+  ColumnarResult cr;
+  for (int j = 0; j < info.fields.size(); ++j) {
+    cr.columns.push_back(QueryColumn(info.fields[j], info.types[j]));
+  }
+
+  try {
+    for (; stmt->Step(); ++cr.nrows) {
+      for (int j = 0; j < cr.columns.size(); ++j) {
+        QueryColumn& c = cr.columns[j];
+        switch (c.type) {
+          case INT:  // fallthrough
+          case BOOL:
+            c.ints.push_back(stmt->GetInt(j));
+            break;
+          case DOUBLE:  // fallthrough
+          case FLOAT:
+            c.doubles.push_back(stmt->GetDouble(j));
+            break;
+          case STRING:
+            c.AppendStr(stmt->GetText(j, NULL));
+            break;
+          case UUID: {
+            boost::uuids::uuid u;
+            memcpy(&u, stmt->GetText(j, NULL), 16);
+            c.AppendUuid(u);
+            break;
+          }
+          default:
+            c.vals.push_back(ColAsVal(stmt, j, c.type));
+        }
+      }
+    }
+    stmt->Reset();
+  } catch (...) {
+    queries_.erase(sql);
+    throw;
+  }
+  return cr;
+}
 
-  std::stringstream sql;
-  sql << "SELECT * FROM " << table;
+SqlStatement::Ptr SqliteBack::Select(std::string table,
+                                     std::vector<Cond>* conds,
+                                     std::vector<std::string>* cols,
+                                     std::string* sql, bool cached) {
+  CreateIndexes(table);
+
+  std::stringstream ss;
+  ss << "SELECT ";
+  if (cols == NULL) {
+    ss << "*";
+  } else {
+    for (int i = 0; i < cols->size(); ++i) {
+      ss << (i > 0 ? "," : "") << (*cols)[i];
+    }
+  }
+  ss << " FROM " << table;
   if (conds != NULL) {
-    sql << " WHERE ";
+    ss << " WHERE ";
     for (int i = 0; i < conds->size(); ++i) {
       if (i > 0) {
-        sql << " AND ";
+        ss << " AND ";
       }
       Cond c = (*conds)[i];
-      sql << c.field << " " << c.op << " ?";
+      ss << c.field << " " << c.op << " ?";
     }
   }
-  sql << ";";
+  ss << ";";
+  *sql = ss.str();
 
-  SqlStatement::Ptr stmt = db_.Prepare(sql.str());
+  SqlStatement::Ptr stmt;
+  if (!cached) {
+    stmt = db_.Prepare(*sql);
+  } else if ((stmt = queries_[*sql]) == NULL) {
+    stmt = db_.Prepare(*sql);
+    queries_[*sql] = stmt;
+  }
 
   if (conds != NULL) {
     for (int i = 0; i < conds->size(); ++i) {
@@ -125,15 +364,7 @@ QueryResult SqliteBack::Query(std::string table, std::vector<Cond>* conds) {
       Bind(v, Type(v), stmt, i+1);
     }
   }
-
-  for (int i = 0; stmt->Step(); ++i) {
-    QueryRow r;
-    for (int j = 0; j < q.fields.size(); ++j) {
-      r.push_back(ColAsVal(stmt, j, q.types[j]));
-    }
-    q.rows.push_back(r);
-  }
-  return q;
+  return stmt;
 }
 
 std::map<std::string, DbTypes> SqliteBack::ColumnTypes(std::string table) {
@@ -163,6 +394,11 @@ SqliteDb& SqliteBack::db() {
 }
 
 QueryResult SqliteBack::GetTableInfo(std::string table) {
+  std::map<std::string, QueryResult>::iterator it = table_info_.find(table);
+  if (it != table_info_.end()) {
+    return it->second;
+  }
+
   std::string sql = "SELECT Field,Type FROM FieldTypes WHERE TableName = '" +
                     table + "';";
   SqlStatement::Ptr stmt;
@@ -177,6 +413,16 @@ QueryResult SqliteBack::GetTableInfo(std::string table) {
   if (i == 0) {
     throw ValueError("Invalid table name " + table);
   }
+  table_info_[table] = info;
+  return info;
+}
+
+QueryResult SqliteBack::GetTableInfo(std::string table,
+                                     std::vector<std::string>* cols) {
+  QueryResult info = GetTableInfo(table);
+  if (cols != NULL) {
+    info.Project(*cols);
+  }
   return info;
 }
 
@@ -185,28 +431,37 @@ std::string SqliteBack::Name() {
 }
 
 void SqliteBack::BuildStmt(Datum* d) {
-  std::string name = d->title();
-  Datum::Vals vals = d->vals();
+  const std::string& name = d->title();
+  const Datum::Vals& vals = d->vals();
   std::vector<DbTypes> schema;
-
-  schema.push_back(Type(vals[0].second));
-  std::string insert = "INSERT INTO " + name + " VALUES (?";
-  for (int i = 1; i < vals.size(); ++i) {
+  for (int i = 0; i < vals.size(); ++i) {
     schema.push_back(Type(vals[i].second));
-    insert += ", ?";
   }
-  insert += ");";
 
   schemas_[name] = schema;
-  stmts_[name] = db_.Prepare(insert);
+  stmts_[name] = db_.Prepare(InsertSql(name, vals.size(), 1));
+}
+
+std::string SqliteBack::InsertSql(std::string table, int ncols, int nrows) {
+  std::string row = "(?";
+  for (int i = 1; i < ncols; ++i) {
+    row += ", ?";
+  }
+  row += ")";
+
+  std::string insert = "INSERT INTO " + table + " VALUES " + row;
+  for (int i = 1; i < nrows; ++i) {
+    insert += ", " + row;
+  }
+  return insert + ";";
 }
 
 void SqliteBack::CreateTable(Datum* d) {
   std::string name = d->title();
   tbl_names_.insert(name);
 
-  Datum::Vals vals = d->vals();
-  Datum::Vals::iterator it = vals.begin();
+  const Datum::Vals& vals = d->vals();
+  Datum::Vals::const_iterator it = vals.begin();
 
   std::stringstream types;
   types << "INSERT INTO FieldTypes VALUES ('"
@@ -232,37 +487,35 @@ void SqliteBack::CreateTable(Datum* d) {
   db_.Execute(cmd);
 }
 
-void SqliteBack::WriteDatum(Datum* d) {
-  Datum::Vals vals = d->vals();
-  SqlStatement::Ptr stmt = stmts_[d->title()];
-  std::vector<DbTypes> schema = schemas_[d->title()];
-
+void SqliteBack::BindDatum(Datum* d, const SqlStatement::Ptr& stmt,
+                           const std::vector<DbTypes>& schema, int offset) {
+  const Datum::Vals& vals = d->vals();
   for (int i = 0; i < vals.size(); ++i) {
-    boost::spirit::hold_any v = vals[i].second;
-    Bind(v, schema[i], stmt, i+1);
+    Bind(vals[i].second, schema[i], stmt, offset + i + 1);
   }
-
-  stmt->Exec();
 }
 
-void SqliteBack::Bind(boost::spirit::hold_any v, DbTypes type, SqlStatement::Ptr stmt,
-                      int index) {
+void SqliteBack::Bind(const boost::spirit::hold_any& v, DbTypes type,
+                      const SqlStatement::Ptr& stmt, int index) {
 
 // serializes the value v of type T and DBType D and binds it to stmt (inside
-// a case statement.
+// a case statement.  Bulk mode uses the (faster, but platform dependent)
+// binary archive format instead of xml.
 // NOTE: Since we are archiving to a stringstream, the archive must be closed before
 // the stringstream, so we put it in its own scope. This first became an issue in
 // Boost v1.66.0.  For more information, see http://boost.2283326.n4.nabble.com/the-boost-xml-serialization-to-a-stringstream-does-not-have-an-end-tag-tp2580772p2580773.html
 #define CYCLUS_COMMA ,
 #define CYCLUS_BINDVAL(D, T) \
     case D: { \
-    T vect = v.cast<T>(); \
+    const T& vect = v.cast<T>(); \
     std::stringstream ss; \
-    { \
+    if (bulk_) { \
+      boost::archive::binary_oarchive ar(ss); \
+      ar & BOOST_SERIALIZATION_NVP(vect); \
+    } else { \
       boost::archive::xml_oarchive ar(ss); \
       ar & BOOST_SERIALIZATION_NVP(vect); \
     } \
-    v = vect; \
     std::string s = ss.str(); \
     stmt->BindBlob(index, s.c_str(), s.size()); \
     break; \
@@ -286,7 +539,7 @@ void SqliteBack::Bind(boost::spirit::hold_any v, DbTypes type, SqlStatement::Ptr
     break;
   }
   case BLOB: {
-      std::string s = v.cast<Blob>().str();
+      const std::string& s = v.cast<Blob>().str();
       stmt->BindBlob(index, s.c_str(), s.size());
       break;
     }
@@ -295,7 +548,7 @@ void SqliteBack::Bind(boost::spirit::hold_any v, DbTypes type, SqlStatement::Ptr
     break;
   }
   case UUID: {
-    boost::uuids::uuid ui = v.cast<boost::uuids::uuid>();
+    const boost::uuids::uuid& ui = v.cast<boost::uuids::uuid>();
     stmt->BindBlob(index, ui.data, 16);
     break;
   }
@@ -366,16 +619,22 @@ boost::spirit::hold_any SqliteBack::ColAsVal(SqlStatement::Ptr stmt,
   boost::spirit::hold_any v;
 
 // reconstructs from a serialization in stmt of type T and DbType D and
-// store it in v.
+// store it in v.  Values written in bulk mode are binary archives, which
+// (unlike xml) don't start with '<'.
 #define CYCLUS_COMMA ,
 #define CYCLUS_LOADVAL(D, T) \
       case D: { \
-      char* data =  stmt->GetText(col, NULL); \
-      std::stringstream ss; \
-      ss << data; \
-      boost::archive::xml_iarchive ar(ss); \
+      int n; \
+      char* data =  stmt->GetText(col, &n); \
+      std::stringstream ss(data == NULL ? "" : std::string(data, n)); \
       T vect; \
-      ar & BOOST_SERIALIZATION_NVP(vect); \
+      if (n > 0 && data[0] != '<') { \
+        boost::archive::binary_iarchive ar(ss); \
+        ar & BOOST_SERIALIZATION_NVP(vect); \
+      } else { \
+        boost::archive::xml_iarchive ar(ss); \
+        ar & BOOST_SERIALIZATION_NVP(vect); \
+      } \
       v = vect; \
       break; \
       }
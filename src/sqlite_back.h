@@ -14,7 +14,18 @@ namespace cyclus {
 /// named Datum objects have their data placed as rows in a single table.  Handles the
 /// following datum value types: int, float, double, std::string, cyclus::Blob.
 /// Unsupported value types are stored as an empty string.
+///
+/// Tables are written without indexes.  Indexes on a configurable set of
+/// columns (SimId, AgentId, Time and ResourceId by default) are created for
+/// a table the first time it is queried and for every table on Close, i.e.
+/// after the bulk of the data has been loaded (the cyclus command line closes
+/// its output backend at the end of a run).  Read-only databases are queried
+/// without indexes.  Prepared SELECT statements are cached per table and
+/// condition shape and the table schemas are cached, so repeated queries only
+/// rebind their condition values.
 class SqliteBack: public FullBackend {
+  friend class SqliteCursor;
+
  public:
   /// Creates a new sqlite backend that will write to the database file
   /// specified by path. If the file doesn't exist, a new one is created.
@@ -33,24 +44,81 @@ class SqliteBack: public FullBackend {
   /// Executes all pending commands.
   void Flush();
 
-  /// Closes the backend, if approriate.
-  void Close() {};
+  /// Creates the indexes for all tables.  The database stays open.
+  void Close();
 
   virtual QueryResult Query(std::string table, std::vector<Cond>* conds);
 
+  /// Reads the matching rows directly into typed columns.
+  virtual ColumnarResult QueryColumns(std::string table,
+                                      std::vector<Cond>* conds);
+
+  /// Returns a cursor that steps its own prepared statement, so rows are
+  /// read from the database only as they are fetched.
+  virtual QueryCursor::Ptr Cursor(std::string table, std::vector<Cond>* conds);
+
+  /// Only selects the requested columns from the database.
+  virtual QueryResult Query(std::string table, std::vector<Cond>* conds,
+                            std::vector<std::string>* cols);
+
+  virtual ColumnarResult QueryColumns(std::string table,
+                                      std::vector<Cond>* conds,
+                                      std::vector<std::string>* cols);
+
+  virtual QueryCursor::Ptr Cursor(std::string table, std::vector<Cond>* conds,
+                                  std::vector<std::string>* cols);
+
   virtual std::map<std::string, DbTypes> ColumnTypes(std::string table);
 
   virtual std::set<std::string> Tables();
 
+  /// Switches bulk load mode on or off.  In bulk mode sqlite's rollback
+  /// journal is disabled, the database file is locked exclusively and a large
+  /// page cache is used.  Rows of the same table are inserted in batches by
+  /// multi-row statements and container values are stored as binary rather
+  /// than xml archives.  This makes writing much faster, but a crash during a
+  /// write can corrupt the database and the binary values can only be read on
+  /// platforms with the same binary archive format.
+  void set_bulk(bool bulk);
+
+  /// Returns true if the backend is in bulk load mode.
+  bool bulk() const { return bulk_; }
+
+  /// Sets the names of the columns to index in every table that has them.  An
+  /// empty set disables index creation.  Tables that were already indexed are
+  /// left as they are.
+  void index_fields(const std::set<std::string>& fields);
+
+  /// Returns the names of the columns that are indexed.
+  const std::set<std::string>& index_fields() const { return index_fields_; }
+
   /// Returns the underlying sqlite database. Only use this if you really know
   /// what you are doing.
   SqliteDb& db();
 
  private:
-  void Bind(boost::spirit::hold_any v, DbTypes type, SqlStatement::Ptr stmt, int index);
+  void Bind(const boost::spirit::hold_any& v, DbTypes type,
+            const SqlStatement::Ptr& stmt, int index);
 
+  /// returns the fields and types of table (without rows), which are
+  /// cached after the first lookup.
   QueryResult GetTableInfo(std::string table);
-  
+
+  /// returns the fields and types of the columns cols of table (all columns
+  /// if cols is NULL).
+  QueryResult GetTableInfo(std::string table, std::vector<std::string>* cols);
+
+  /// returns the cached SELECT statement for the table, columns (all if cols
+  /// is NULL) and condition shape with the condition values bound.  sql is
+  /// set to the statement's sql.  If cached is false, a new statement is
+  /// prepared and not cached.
+  SqlStatement::Ptr Select(std::string table, std::vector<Cond>* conds,
+                           std::vector<std::string>* cols, std::string* sql,
+                           bool cached = true);
+
+  /// creates the indexes for table if that hasn't been done yet.
+  void CreateIndexes(std::string table);
+
   std::list<ColumnInfo> Schema(std::string table);
 
   /// returns a valid sql data type name for v (e.g.  INTEGER, REAL, TEXT, etc).
@@ -68,8 +136,14 @@ class SqliteBack: public FullBackend {
 
   void BuildStmt(Datum* d);
 
-  /// constructs an SQL INSERT command for d and queues it for db insertion.
-  void WriteDatum(Datum* d);
+  /// returns the sql to insert nrows rows with ncols columns into table.
+  std::string InsertSql(std::string table, int ncols, int nrows);
+
+  /// binds the values of d to the prepared INSERT statement stmt for its
+  /// table, using the cached column types in schema.  The values are bound to
+  /// the parameters following the first offset ones.
+  void BindDatum(Datum* d, const SqlStatement::Ptr& stmt,
+                 const std::vector<DbTypes>& schema, int offset);
 
   /// An interface to a sqlite db managed by the SqliteBack class.
   SqliteDb db_;
@@ -82,6 +156,22 @@ class SqliteBack: public FullBackend {
 
   std::map<std::string, SqlStatement::Ptr> stmts_;
   std::map<std::string, std::vector<DbTypes> > schemas_;
+
+  /// multi-row INSERT statements used in bulk mode.
+  std::map<std::string, SqlStatement::Ptr> batch_stmts_;
+
+  bool bulk_;
+
+  /// prepared SELECT statements keyed by their sql, which is determined by
+  /// the table and the fields and operators of the query conditions.
+  std::map<std::string, SqlStatement::Ptr> queries_;
+
+  /// cached results of GetTableInfo.
+  std::map<std::string, QueryResult> table_info_;
+
+  /// column names to index and the tables that have been indexed.
+  std::set<std::string> index_fields_;
+  std::set<std::string> indexed_;
 };
 
 }  // namespace cyclus
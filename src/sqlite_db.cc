@@ -129,6 +129,12 @@ void SqliteDb::open() {
   }
 }
 
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+bool SqliteDb::readonly() {
+  open();
+  return sqlite3_db_readonly(db_, "main") == 1;
+}
+
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 SqlStatement::Ptr SqliteDb::Prepare(std::string sql) {
   open();
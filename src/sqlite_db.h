@@ -98,6 +98,10 @@ class SqliteDb {
   /// overwrite it with a new empty database.
   void Overwrite();
 
+  /// Returns true if the database can't be written to, either because it was
+  /// opened readonly or because sqlite couldn't open its file for writing.
+  bool readonly();
+
   /// Creates a sqlite prepared statement for the given sql.  See
   /// http://sqlite.org/cintro.html for an overview of how prepared statements
   /// work.
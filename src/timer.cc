@@ -1,10 +1,14 @@
 // Implements the Timer class
 #include "timer.h"
 
+#include <exception>
 #include <iostream>
+#include <map>
 #include <string>
+#include <thread>
 
 #include "agent.h"
+#include "comp_vec.h"
 #include "error.h"
 #include "logger.h"
 #include "pyhooks.h"
@@ -86,8 +90,34 @@ void Timer::DoTick() {
 
 void Timer::DoResEx(ExchangeManager<Material>* matmgr,
                     ExchangeManager<Product>* genmgr) {
-  matmgr->Execute();
-  genmgr->Execute();
+  if (matmgr->nthreads() < 2 && genmgr->nthreads() < 2) {
+    matmgr->Execute();
+    genmgr->Execute();
+    return;
+  }
+
+  // threaded exchange: gather both resource types concurrently, then resolve
+  // them in the usual order on this thread.
+  std::exception_ptr err;
+  std::thread gen([genmgr, &err]() {
+    try {
+      genmgr->Gather();
+    } catch (...) {
+      err = std::current_exception();
+    }
+  });
+  try {
+    matmgr->Gather();
+  } catch (...) {
+    gen.join();
+    throw;
+  }
+  gen.join();
+  if (err) {
+    std::rethrow_exception(err);
+  }
+  matmgr->Resolve();
+  genmgr->Resolve();
 }
 
 void Timer::DoTock() {
@@ -123,23 +153,52 @@ void Timer::RecordInventories(Agent* a) {
   Inventories::iterator it2;
   for (it2 = invs.begin(); it2 != invs.end(); ++it2) {
     std::string name = it2->first;
-    std::vector<Resource::Ptr> mats = it2->second;
+    std::vector<Resource::Ptr>& mats = it2->second;
     if (mats.empty() || ResCast<Material>(mats[0]) == NULL) {
       continue; // skip non-material inventories
     }
 
-    Material::Ptr m = ResCast<Material>(mats[0]->Clone());
-    for (int i = 1; i < mats.size(); i++) {
-      m->Absorb(ResCast<Material>(mats[i]->Clone()));
+    // Sum the quantities of materials sharing a composition first so that the
+    // mass vectors of each distinct composition are only added once. This
+    // gives the same totals as absorbing all the materials into one without
+    // creating (and tracking) any new materials or compositions.
+    // In lazy decay mode, the compositions are decayed in one batch.
+    std::vector<Material::Ptr> ms;
+    for (int i = 0; i < mats.size(); i++) {
+      ms.push_back(ResCast<Material>(mats[i]));
+    }
+    std::vector<Composition::Ptr> decayed = Material::DecayedComps(ms);
+
+    std::vector<Composition::Ptr> comps;
+    std::vector<double> qtys;
+    std::map<Composition*, int> index;
+    double qty = 0;
+    for (int i = 0; i < ms.size(); i++) {
+      Material::Ptr m = ms[i];
+      Composition::Ptr c = decayed[i];
+      std::pair<std::map<Composition*, int>::iterator, bool> ins =
+          index.insert(std::make_pair(c.get(), comps.size()));
+      if (ins.second) {
+        comps.push_back(c);
+        qtys.push_back(0);
+      }
+      qtys[ins.first->second] += m->quantity();
+      qty += m->quantity();
+    }
+
+    CompVec mass;
+    for (int i = 0; i < comps.size(); i++) {
+      CompVec v(comps[i]->mass());
+      v.Normalize(qtys[i]);
+      mass = CompVec::Add(mass, v);
     }
-    RecordInventory(a, name, m);
+    RecordInventory(a, name, mass.ToCompMap(), qty);
   }
 }
 
-void Timer::RecordInventory(Agent* a, std::string name, Material::Ptr m) {
+void Timer::RecordInventory(Agent* a, std::string name, CompMap c,
+                            double qty) {
   if (si_.explicit_inventory) {
-    CompMap c = m->comp()->mass();
-    compmath::Normalize(&c, m->quantity());
     CompMap::iterator it;
     for (it = c.begin(); it != c.end(); ++it) {
       ctx_->NewDatum("ExplicitInventory")
@@ -153,13 +212,12 @@ void Timer::RecordInventory(Agent* a, std::string name, Material::Ptr m) {
   }
 
   if (si_.explicit_inventory_compact) {
-    CompMap c = m->comp()->mass();
     compmath::Normalize(&c, 1);
     ctx_->NewDatum("ExplicitInventoryCompact")
         ->AddVal("AgentId", a->id())
         ->AddVal("Time", time_)
         ->AddVal("InventoryName", name)
-        ->AddVal("Quantity", m->quantity())
+        ->AddVal("Quantity", qty)
         ->AddVal("Composition", c)
         ->Record();
   }
@@ -77,7 +77,11 @@ class Timer {
   /// notifications.
   void DoTick();
 
-  /// Runs the resource exchange process for all traders.
+  /// Runs the resource exchange process for all traders. When the threaded
+  /// exchange is enabled, requests and bids for products are gathered
+  /// concurrently with those for materials (i.e. before material trades are
+  /// executed); preference adjustment, solving and trade execution still run
+  /// for materials first and then products.
   void DoResEx(ExchangeManager<Material>* matmgr,
                ExchangeManager<Product>* genmgr);
 
@@ -90,7 +94,10 @@ class Timer {
   void DoDecision();
 
   void RecordInventories(Agent* a);
-  void RecordInventory(Agent* a, std::string name, Material::Ptr m);
+
+  /// records the inventory of agent a with the given name, whose mass vector
+  /// (normalized to its quantity) is c
+  void RecordInventory(Agent* a, std::string name, CompMap c, double qty);
 
   /// decommissions all agents queued for the current timestep.
   void DoDecom();
@@ -154,15 +154,19 @@ std::set<BidPortfolio<Material>::Ptr> MatlSellPolicy::GetMatlBids(
       qty = std::min(req->target()->quantity(), limit);
       nbids = excl ? static_cast<int>(std::floor(qty / quantize_)) : 1;
       qty = excl ? quantize_ : qty;
-      for (int i = 0; i < nbids; i++) {
-        m = buf_->Pop();
-        buf_->Push(m);
-        offer = ignore_comp_ ? \
-                Material::CreateUntracked(qty, req->target()->comp()) : \
-                Material::CreateUntracked(qty, m->comp());
-        port->AddBid(req, offer, this, excl);
-        LG(INFO3) << "  - bid " << qty << " kg on a request for " << commod;
+      if (nbids < 1) {
+        continue;
       }
+      // the quanta are offered as one bid with a multiplicity
+      m = buf_->Pop();
+      buf_->Push(m);
+      offer = ignore_comp_ ? \
+              Material::CreateUntracked(qty, req->target()->comp()) : \
+              Material::CreateUntracked(qty, m->comp());
+      port->AddBid(req, offer, this, excl,
+                   std::numeric_limits<double>::quiet_NaN(), nbids);
+      LG(INFO3) << "  - bid " << nbids << " x " << qty
+                << " kg on a request for " << commod;
     }
   }
   return ports;
@@ -29,6 +29,49 @@ class Trader {
     return manager_;
   }
 
+  /// @brief returns true if this trader's request and bid queries
+  /// (GetMatlRequests, GetMatlBids, GetProductRequests and GetProductBids)
+  /// may run concurrently with those of other traders and with each other
+  /// when the threaded resource exchange is enabled. The same holds for its
+  /// preference adjustments (AdjustMatlPrefs and AdjustProductPrefs), which
+  /// run concurrently with those of other requesters if its parents are
+  /// thread safe as well (see Agent::ThreadSafePrefs). Traders returning true
+  /// may create resources and record output from those calls, but must not
+  /// build or decommission agents or modify state shared with other agents.
+  /// Defaults to false, in which case the trader is always called from a
+  /// single thread.
+  virtual bool ThreadSafeExchange() {
+    return false;
+  }
+
+  /// @brief returns true if GetMatlRequests would return the same portfolios
+  /// as it did on the previous time step. The exchange then reuses those
+  /// portfolios, with the same requests, instead of calling GetMatlRequests.
+  /// MatlBidsUnchanged does the same for GetMatlBids, except that bid
+  /// portfolios are only reused if the requests for every commodity bid on are
+  /// also unchanged. A trader that may start bidding on another commodity
+  /// should not report its bids as unchanged. Both default to false, in which
+  /// case the trader is queried on every time step.
+  /// @{
+  virtual bool MatlRequestsUnchanged() {
+    return false;
+  }
+  virtual bool MatlBidsUnchanged() {
+    return false;
+  }
+  /// @}
+
+  /// @brief the product versions of MatlRequestsUnchanged and
+  /// MatlBidsUnchanged
+  /// @{
+  virtual bool ProductRequestsUnchanged() {
+    return false;
+  }
+  virtual bool ProductBidsUnchanged() {
+    return false;
+  }
+  /// @}
+
   /// @brief default implementation for material requests
   virtual std::set<RequestPortfolio<Material>::Ptr>
       GetMatlRequests() {
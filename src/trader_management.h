@@ -46,6 +46,36 @@ inline std::set<BidPortfolio<Product>::Ptr>
   return t->GetProductBids(map);
 }
 
+template<class T>
+inline static bool RequestsUnchanged(Trader* t) {
+  return false;
+}
+
+template<>
+inline bool RequestsUnchanged<Material>(Trader* t) {
+  return t->MatlRequestsUnchanged();
+}
+
+template<>
+inline bool RequestsUnchanged<Product>(Trader* t) {
+  return t->ProductRequestsUnchanged();
+}
+
+template<class T>
+inline static bool BidsUnchanged(Trader* t) {
+  return false;
+}
+
+template<>
+inline bool BidsUnchanged<Material>(Trader* t) {
+  return t->MatlBidsUnchanged();
+}
+
+template<>
+inline bool BidsUnchanged<Product>(Trader* t) {
+  return t->ProductBidsUnchanged();
+}
+
 template<class T>
 inline static void PopulateTradeResponses(
     Trader* trader,
@@ -279,10 +279,13 @@ void XMLFileLoader::LoadSolver() {
     bool verbose = cyclus::OptionalQuery<bool>(&xqe, query, false);
     query = string("/*/control/solver/config/coin-or/mps");
     bool mps = cyclus::OptionalQuery<bool>(&xqe, query, false);
+    query = string("/*/control/solver/config/coin-or/warm_start");
+    bool warm_start = cyclus::OptionalQuery<bool>(&xqe, query, false);
     ctx_->NewDatum("CoinSolverInfo")
       ->AddVal("Timeout", timeout)
       ->AddVal("Verbose", verbose)
       ->AddVal("Mps", mps)
+      ->AddVal("WarmStart", warm_start)
       ->Record();
   } else {
     throw ValueError("unknown solver name: " + solver_name);
@@ -439,6 +442,7 @@ void XMLFileLoader::LoadControlParams() {
 
   si.explicit_inventory = OptionalQuery<bool>(qe, "explicit_inventory", false);
   si.explicit_inventory_compact = OptionalQuery<bool>(qe, "explicit_inventory_compact", false);
+  si.incremental_snapshot = OptionalQuery<bool>(qe, "incremental_snapshot", false);
 
   // get time step duration
   si.dt = OptionalQuery<int>(qe, "dt", kDefaultTimeStepDur);
@@ -1,6 +1,8 @@
 #include <math.h>
+#include <set>
 #include <string>
 #include <utility>
+#include <vector>
 
 #include <gtest/gtest.h>
 
@@ -8,6 +10,7 @@
 #include "composition.h"
 #include "cyc_limits.h"
 #include "material.h"
+#include "parallel.h"
 #include "product.h"
 #include "resource.h"
 #include "test_context.h"
@@ -168,3 +171,62 @@ TEST(CapacityConstraintTests, GenProductQuality) {
   gr = Product::CreateUntracked(quan, "foo");
   EXPECT_DOUBLE_EQ(cc.convert(gr), 0.0);
 }
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+struct CountingConverter : public Converter<Material> {
+  CountingConverter(bool is_pure) : is_pure(is_pure), n(0) {}
+
+  virtual double convert(
+      Material::Ptr r,
+      Arc const * a = NULL,
+      ExchangeTranslationContext<Material> const * ctx = NULL) const {
+    ++n;
+    return r->quantity() * fraction;
+  }
+
+  virtual bool pure() const { return is_pure; }
+
+  bool is_pure;
+  mutable int n;
+};
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+TEST(CapacityConstraintTests, PureCache) {
+  CompMap cm;
+  cm[u235] = val;
+  Composition::Ptr comp = Composition::CreateFromMass(cm);
+  Material::Ptr m1 = Material::CreateUntracked(quantity, comp);
+  Material::Ptr m2 = Material::CreateUntracked(quantity, comp);
+  Material::Ptr m3 = Material::CreateUntracked(2 * quantity, comp);
+
+  boost::shared_ptr<CountingConverter> pure(new CountingConverter(true));
+  boost::shared_ptr<CountingConverter> impure(new CountingConverter(false));
+  CapacityConstraint<Material> cp(val, pure);
+  CapacityConstraint<Material> ci(val, impure);
+  ExchangeTranslationContext<Material> ctx;
+
+  // offers of the same quality and quantity are converted once per context
+  EXPECT_DOUBLE_EQ(quantity * fraction, cp.convert(m1, NULL, &ctx));
+  EXPECT_DOUBLE_EQ(quantity * fraction, cp.convert(m2, NULL, &ctx));
+  EXPECT_EQ(1, pure->n);
+  EXPECT_DOUBLE_EQ(2 * quantity * fraction, cp.convert(m3, NULL, &ctx));
+  EXPECT_EQ(2, pure->n);
+  cp.convert(m1);
+  EXPECT_EQ(3, pure->n);
+
+  ci.convert(m1, NULL, &ctx);
+  ci.convert(m2, NULL, &ctx);
+  EXPECT_EQ(2, impure->n);
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+TEST(CapacityConstraintTests, ThreadedIds) {
+  // constraints built by traders queried concurrently get distinct ids
+  int n = 1000;
+  std::vector<int> ids(n);
+  cyclus::ParallelFor(n, 4, [&](int i, int thread) {
+    CapacityConstraint<Material> cc(val);
+    ids[i] = cc.id();
+  });
+  EXPECT_EQ(n, std::set<int>(ids.begin(), ids.end()).size());
+}
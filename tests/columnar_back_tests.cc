@@ -0,0 +1,261 @@
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "boost/filesystem.hpp"
+#include "boost/uuid/uuid_generators.hpp"
+
+#include "blob.h"
+#include "columnar_back.h"
+#include "error.h"
+#include "recorder.h"
+
+static const char* colpath = "testdb.cyccol";
+
+// removes the backend's directory before and after a test
+class DirDeleter {
+ public:
+  DirDeleter(std::string path) : path_(path) {
+    boost::filesystem::remove_all(path_);
+  }
+
+  ~DirDeleter() { boost::filesystem::remove_all(path_); }
+
+ private:
+  std::string path_;
+};
+
+static void RecordAgents(cyclus::Recorder* r, int begin, int end) {
+  for (int i = begin; i < end; ++i) {
+    r->NewDatum("Agents")
+        ->AddVal("AgentId", i)
+        ->AddVal("Alive", i % 2 == 0)
+        ->AddVal("Mass", 0.5 * i)
+        ->AddVal("Frac", 0.25f)
+        ->AddVal("Name", std::string(i % 3 ? "fac" : "inst"))
+        ->AddVal("Data", cyclus::Blob(std::string(i % 5, 'x')))
+        ->Record();
+  }
+}
+
+TEST(ColumnarBackTest, ReadWrite) {
+  using cyclus::Cond;
+  using cyclus::QueryResult;
+  DirDeleter dd(colpath);
+  cyclus::Recorder r;
+  cyclus::ColumnarBack back(colpath);
+  back.page_rows(10);
+  r.RegisterBackend(&back);
+  RecordAgents(&r, 0, 95);
+  r.Flush();
+
+  EXPECT_EQ(1, back.Tables().count("Agents"));
+  std::map<std::string, cyclus::DbTypes> types = back.ColumnTypes("Agents");
+  EXPECT_EQ(cyclus::UUID, types["SimId"]);
+  EXPECT_EQ(cyclus::BOOL, types["Alive"]);
+  EXPECT_EQ(cyclus::FLOAT, types["Frac"]);
+  EXPECT_EQ(cyclus::STRING, types["Name"]);
+  EXPECT_EQ(cyclus::BLOB, types["Data"]);
+
+  QueryResult qr = back.Query("Agents", NULL);
+  ASSERT_EQ(95, qr.rows.size());
+  EXPECT_EQ(r.sim_id(), qr.GetVal<boost::uuids::uuid>("SimId", 42));
+  EXPECT_EQ(42, qr.GetVal<int>("AgentId", 42));
+  EXPECT_TRUE(qr.GetVal<bool>("Alive", 42));
+  EXPECT_DOUBLE_EQ(21, qr.GetVal<double>("Mass", 42));
+  EXPECT_FLOAT_EQ(0.25, qr.GetVal<float>("Frac", 42));
+  EXPECT_EQ("inst", qr.GetVal<std::string>("Name", 42));
+  EXPECT_EQ("xx", qr.GetVal<cyclus::Blob>("Data", 42).str());
+
+  std::vector<Cond> conds;
+  conds.push_back(Cond("AgentId", ">=", 30));
+  conds.push_back(Cond("AgentId", "<", 60));
+  conds.push_back(Cond("Name", "==", std::string("inst")));
+  qr = back.Query("Agents", &conds);
+  ASSERT_EQ(10, qr.rows.size());
+  EXPECT_EQ(30, qr.GetVal<int>("AgentId", 0));
+  EXPECT_EQ(57, qr.GetVal<int>("AgentId", 9));
+
+  cyclus::ColumnarResult cr = back.QueryColumns("Agents", &conds);
+  ASSERT_EQ(10, cr.nrows);
+  EXPECT_EQ(57, cr.column("AgentId").ints[9]);
+  EXPECT_EQ(1, cr.column("Name").strs.size());
+  EXPECT_EQ(10, cr.column("Name").codes.size());
+  EXPECT_EQ(1, cr.column("SimId").uuids.size());
+
+  // batches of a cursor cut across pages
+  cyclus::QueryCursor::Ptr c = back.Cursor("Agents", NULL);
+  int nrows = 0;
+  while (c->Fetch(7, &qr)) {
+    EXPECT_EQ(nrows, qr.GetVal<int>("AgentId", 0));
+    nrows += qr.rows.size();
+  }
+  EXPECT_EQ(95, nrows);
+
+  conds.clear();
+  conds.push_back(Cond("Foo", "==", 1));
+  EXPECT_THROW(back.Query("Agents", &conds), cyclus::ValueError);
+  EXPECT_THROW(back.Query("Missing", NULL), cyclus::IOError);
+  r.NewDatum("Bad")->AddVal("x", std::vector<float>())->Record();
+  EXPECT_THROW(r.Flush(), cyclus::ValueError);
+  EXPECT_EQ(0, back.Tables().count("Bad"));
+  EXPECT_FALSE(boost::filesystem::exists(std::string(colpath) +
+                                         "/Bad.cyccol"));
+  r.Close();
+}
+
+TEST(ColumnarBackTest, Mismatch) {
+  DirDeleter dd(colpath);
+  cyclus::Recorder r;
+  cyclus::ColumnarBack back(colpath);
+  r.RegisterBackend(&back);
+  RecordAgents(&r, 0, 3);
+
+  // a datum whose last column has the wrong type or a renamed column is
+  // rejected without buffering any of its values
+  r.NewDatum("Agents")
+      ->AddVal("AgentId", 3)
+      ->AddVal("Alive", true)
+      ->AddVal("Mass", 1.5)
+      ->AddVal("Frac", 0.25f)
+      ->AddVal("Name", std::string("fac"))
+      ->AddVal("Data", 4)
+      ->Record();
+  EXPECT_THROW(r.Flush(), cyclus::ValueError);
+  r.NewDatum("Agents")
+      ->AddVal("AgentId", 3)
+      ->AddVal("Alive", true)
+      ->AddVal("Mass", 1.5)
+      ->AddVal("Frac", 0.25f)
+      ->AddVal("Label", std::string("fac"))
+      ->AddVal("Data", cyclus::Blob("x"))
+      ->Record();
+  EXPECT_THROW(r.Flush(), cyclus::ValueError);
+
+  RecordAgents(&r, 3, 5);
+  r.Close();
+  cyclus::QueryResult qr = back.Query("Agents", NULL);
+  ASSERT_EQ(5, qr.rows.size());
+  EXPECT_EQ(4, qr.GetVal<int>("AgentId", 4));
+  EXPECT_EQ("x", qr.GetVal<cyclus::Blob>("Data", 1).str());
+}
+
+TEST(ColumnarBackTest, Containers) {
+  DirDeleter dd(colpath);
+  cyclus::Recorder r;
+  cyclus::ColumnarBack back(colpath);
+  back.page_rows(2);
+  r.RegisterBackend(&back);
+  for (int i = 0; i < 3; ++i) {
+    std::vector<std::string> commods(i, "fuel");
+    std::map<int, double> comp;
+    comp[922350000] = 0.1 * i;
+    r.NewDatum("Sinks")
+        ->AddVal("AgentId", i)
+        ->AddVal("Commods", commods)
+        ->AddVal("Comp", comp)
+        ->Record();
+  }
+  r.Close();
+
+  std::map<std::string, cyclus::DbTypes> types = back.ColumnTypes("Sinks");
+  EXPECT_EQ(cyclus::VECTOR_STRING, types["Commods"]);
+  EXPECT_EQ(cyclus::MAP_INT_DOUBLE, types["Comp"]);
+  cyclus::QueryResult qr = back.Query("Sinks", NULL);
+  ASSERT_EQ(3, qr.rows.size());
+  EXPECT_EQ(std::vector<std::string>(2, "fuel"),
+            qr.GetVal<std::vector<std::string> >("Commods", 2));
+  EXPECT_TRUE(qr.GetVal<std::vector<std::string> >("Commods", 0).empty());
+  EXPECT_DOUBLE_EQ(
+      0.1, (qr.GetVal<std::map<int, double> >("Comp", 1)[922350000]));
+
+  std::vector<cyclus::Cond> conds;
+  conds.push_back(cyclus::Cond("Comp", "==", std::map<int, double>()));
+  EXPECT_THROW(back.Query("Sinks", &conds), cyclus::ValueError);
+}
+
+TEST(ColumnarBackTest, Projection) {
+  using cyclus::Cond;
+  DirDeleter dd(colpath);
+  cyclus::Recorder r;
+  cyclus::ColumnarBack back(colpath);
+  back.page_rows(10);
+  r.RegisterBackend(&back);
+  RecordAgents(&r, 0, 35);
+  r.Flush();
+
+  // the condition's column is decoded but not returned
+  std::vector<Cond> conds;
+  conds.push_back(Cond("Name", "==", std::string("inst")));
+  std::vector<std::string> cols;
+  cols.push_back("Data");
+  cols.push_back("AgentId");
+  cyclus::QueryResult qr = back.Query("Agents", &conds, &cols);
+  EXPECT_EQ(cols, qr.fields);
+  EXPECT_EQ(cyclus::BLOB, qr.types[0]);
+  ASSERT_EQ(12, qr.rows.size());
+  ASSERT_EQ(2, qr.rows[0].size());
+  EXPECT_EQ(6, qr.GetVal<int>("AgentId", 2));
+  EXPECT_EQ("x", qr.GetVal<cyclus::Blob>("Data", 2).str());
+
+  cyclus::ColumnarResult cr = back.QueryColumns("Agents", &conds, &cols);
+  ASSERT_EQ(2, cr.columns.size());
+  EXPECT_EQ(12, cr.nrows);
+  EXPECT_EQ(33, cr.column("AgentId").ints[11]);
+
+  cyclus::QueryCursor::Ptr c = back.Cursor("Agents", NULL, &cols);
+  ASSERT_TRUE(c->Fetch(15, &qr));
+  EXPECT_EQ(15, qr.rows.size());
+  EXPECT_EQ(14, qr.GetVal<int>("AgentId", 14));
+
+  cols.push_back("Foo");
+  EXPECT_THROW(back.Query("Agents", NULL, &cols), cyclus::KeyError);
+  cols.clear();
+  EXPECT_THROW(back.Query("Agents", NULL, &cols), cyclus::ValueError);
+  r.Close();
+}
+
+TEST(ColumnarBackTest, Append) {
+  DirDeleter dd(colpath);
+  {
+    cyclus::Recorder r;
+    cyclus::ColumnarBack back(colpath);
+    r.RegisterBackend(&back);
+    RecordAgents(&r, 0, 20);
+    r.Close();
+  }
+
+  // rows recorded by a new backend are appended to the existing tables
+  cyclus::Recorder r;
+  cyclus::ColumnarBack back(colpath);
+  r.RegisterBackend(&back);
+  RecordAgents(&r, 20, 25);
+  r.Close();
+  cyclus::QueryResult qr = back.Query("Agents", NULL);
+  ASSERT_EQ(25, qr.rows.size());
+  EXPECT_EQ(24, qr.GetVal<int>("AgentId", 24));
+  EXPECT_EQ("fac", qr.GetVal<std::string>("Name", 20));
+
+  std::ofstream("notadir.cyccol").close();
+  EXPECT_THROW(cyclus::ColumnarBack("notadir.cyccol"), cyclus::IOError);
+  boost::filesystem::remove("notadir.cyccol");
+}
+
+TEST(ColumnarBackTest, Unflushed) {
+  DirDeleter dd(colpath);
+  cyclus::Recorder r;
+  r.set_dump_count(1);
+  cyclus::ColumnarBack back(colpath);
+  r.RegisterBackend(&back);
+  RecordAgents(&r, 0, 5);
+
+  // tables whose rows are all still buffered, e.g. after a crash, are
+  // readable from their creation on
+  cyclus::ColumnarBack reader(colpath);
+  EXPECT_EQ(1, reader.Tables().count("Agents"));
+  EXPECT_EQ(cyclus::BLOB, reader.ColumnTypes("Agents")["Data"]);
+  EXPECT_EQ(0, reader.Query("Agents", NULL).rows.size());
+  r.Close();
+}
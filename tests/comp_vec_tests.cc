@@ -0,0 +1,133 @@
+#include "gtest/gtest.h"
+
+#include "comp_math.h"
+#include "comp_vec.h"
+#include "composition.h"
+#include "env.h"
+#include "error.h"
+
+namespace cm = cyclus::compmath;
+using cyclus::CompMap;
+using cyclus::CompVec;
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+TEST(CompVecTests, RoundTrip) {
+  CompMap v;
+  v[922380000] = 2;
+  v[922350000] = 1;
+  v[10010000] = 3;
+
+  CompVec cv(v);
+  ASSERT_EQ(3, cv.size());
+  EXPECT_EQ(10010000, cv.nucs()[0]);
+  EXPECT_EQ(922350000, cv.nucs()[1]);
+  EXPECT_EQ(922380000, cv.nucs()[2]);
+  EXPECT_DOUBLE_EQ(1, cv.Get(922350000));
+  EXPECT_DOUBLE_EQ(0, cv.Get(942390000));
+  EXPECT_EQ(v, cv.ToCompMap());
+  EXPECT_TRUE(CompVec().empty());
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+TEST(CompVecTests, Append) {
+  CompVec cv;
+  cv.Append(922350000, 1);
+  cv.Append(922380000, 2);
+  EXPECT_THROW(cv.Append(922350000, 1), cyclus::ValueError);
+  EXPECT_EQ(2, cv.size());
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+static void ExpectComp(const CompMap& expected, const CompMap& actual) {
+  ASSERT_EQ(expected.size(), actual.size());
+  CompMap::const_iterator it;
+  for (it = expected.begin(); it != expected.end(); ++it) {
+    ASSERT_EQ(1, actual.count(it->first)) << it->first;
+    EXPECT_DOUBLE_EQ(it->second, actual.find(it->first)->second)
+        << it->first;
+  }
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+TEST(CompVecTests, Arithmetic) {
+  CompMap v1;
+  v1[10010000] = .7;
+  v1[922350000] = .1;
+  v1[922380000] = .2;
+  CompMap v2;
+  v2[922350000] = .05;
+  v2[942390000] = .3;
+
+  CompMap sum;
+  sum[10010000] = .7;
+  sum[922350000] = .15;
+  sum[922380000] = .2;
+  sum[942390000] = .3;
+  ExpectComp(sum, CompVec::Add(CompVec(v1), CompVec(v2)).ToCompMap());
+  ExpectComp(sum, cm::Add(v1, v2));
+
+  // differences keep negative quantities
+  CompMap diff;
+  diff[10010000] = .7;
+  diff[922350000] = .05;
+  diff[922380000] = .2;
+  diff[942390000] = -.3;
+  ExpectComp(diff, CompVec::Sub(CompVec(v1), CompVec(v2)).ToCompMap());
+  ExpectComp(diff, cm::Sub(v1, v2));
+
+  EXPECT_DOUBLE_EQ(1, CompVec(v1).Sum());
+  EXPECT_DOUBLE_EQ(1, cm::Sum(v1));
+
+  CompMap norm;
+  norm[10010000] = 2.94;
+  norm[922350000] = .42;
+  norm[922380000] = .84;
+  CompVec cv(v1);
+  cv.Normalize(4.2);
+  ExpectComp(norm, cv.ToCompMap());
+  CompMap n(v1);
+  cm::Normalize(&n, 4.2);
+  ExpectComp(norm, n);
+
+  // quantities with a magnitude at or below the threshold are removed
+  CompMap thresh;
+  thresh[10010000] = .7;
+  thresh[922380000] = .2;
+  thresh[942390000] = -.3;
+  CompVec ct = CompVec::Sub(CompVec(v1), CompVec(v2));
+  ct.ApplyThreshold(.1);
+  ExpectComp(thresh, ct.ToCompMap());
+  CompMap t = cm::Sub(v1, v2);
+  cm::ApplyThreshold(&t, .1);
+  ExpectComp(thresh, t);
+  EXPECT_THROW(ct.ApplyThreshold(-1), cyclus::ValueError);
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+TEST(CompVecTests, AtomMassConversion) {
+  cyclus::Env::SetNucDataPath();
+
+  // natural uranium is 0.720 atom% and 0.711 weight% U235
+  CompMap atom;
+  atom[922350000] = 0.0072;
+  atom[922380000] = 0.9928;
+  CompVec cv(atom);
+  cv.AtomToMass();
+  cv.Normalize();
+  EXPECT_NEAR(0.0071097, cv.Get(922350000), 1e-6);
+  EXPECT_NEAR(0.9928903, cv.Get(922380000), 1e-6);
+  CompMap mass = cyclus::Composition::CreateFromAtom(atom)->mass();
+  cm::Normalize(&mass);
+  ExpectComp(cv.ToCompMap(), mass);
+
+  cv.MassToAtom();
+  cv.Normalize();
+  ExpectComp(atom, cv.ToCompMap());
+
+  // and the reverse for the same fractions by weight
+  CompVec cw(atom);
+  cw.MassToAtom();
+  cw.Normalize();
+  EXPECT_NEAR(0.0072914, cw.Get(922350000), 1e-6);
+  EXPECT_NEAR(0.9927086, cw.Get(922380000), 1e-6);
+}
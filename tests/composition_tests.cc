@@ -72,6 +72,70 @@ TEST(CompositionTests, lineage) {
   EXPECT_EQ(dec4, dec5);
 }
 
+TEST(CompositionTests, DecayMany) {
+  cyclus::Env::SetNucDataPath();
+
+  Composition::Ptr c1(new TestComp());
+  Composition::Ptr c2(new TestComp());
+  int dt = 5;
+  Composition::Ptr dec1 = c1->Decay(dt);
+
+  std::vector<Composition::Ptr> comps;
+  comps.push_back(c1);
+  comps.push_back(c2);
+  comps.push_back(dec1);
+  comps.push_back(c2);
+  std::vector<Composition::Ptr> decayed = Composition::DecayMany(comps, dt);
+
+  ASSERT_EQ(4, decayed.size());
+  EXPECT_EQ(dec1, decayed[0]);  // already in the decay chain
+  EXPECT_EQ(c2->Decay(dt), decayed[1]);
+  EXPECT_EQ(c1->Decay(2 * dt), decayed[2]);
+  EXPECT_EQ(decayed[1], decayed[3]);  // calculated once
+  EXPECT_NE(decayed[0], decayed[1]);
+}
+
+TEST(CompositionTests, DecayCache) {
+  cyclus::Env::SetNucDataPath();
+  Composition::ClearDecayCache();
+  Composition::decay_cache_capacity(1);
+
+  CompMap v;
+  v[id("Cs137")] = 1;
+  v[id("U238")] = 10;
+  Composition::Ptr c1 = Composition::CreateFromAtom(v);
+  v[id("U238")] *= 1 + 1e-15;  // round-off
+  Composition::Ptr c2 = Composition::CreateFromAtom(v);
+  int dt = 5;
+
+  Composition::Ptr dec1 = c1->Decay(dt);
+  EXPECT_EQ(0, Composition::decay_cache_hits());
+  EXPECT_EQ(1, Composition::decay_cache_misses());
+
+  // separate decay chains share the cached result
+  Composition::Ptr dec2 = c2->Decay(dt);
+  EXPECT_NE(dec1, dec2);
+  EXPECT_EQ(dec1->atom(), dec2->atom());
+  EXPECT_EQ(1, Composition::decay_cache_hits());
+  EXPECT_EQ(1, Composition::decay_cache_misses());
+
+  // a different decay time evicts the only entry
+  std::vector<Composition::Ptr> comps(1, Composition::CreateFromAtom(v));
+  Composition::DecayMany(comps, 2 * dt);
+  comps[0] = Composition::CreateFromAtom(v);
+  Composition::DecayMany(comps, dt);
+  EXPECT_EQ(1, Composition::decay_cache_hits());
+  EXPECT_EQ(3, Composition::decay_cache_misses());
+
+  Composition::decay_cache_capacity(0);
+  Composition::CreateFromAtom(v)->Decay(dt);
+  EXPECT_EQ(3, Composition::decay_cache_misses());
+
+  Composition::ClearDecayCache();
+  EXPECT_EQ(0, Composition::decay_cache_hits());
+  EXPECT_EQ(0, Composition::decay_cache_misses());
+}
+
 TEST(CompositionTests, decay) {
   cyclus::Env::SetNucDataPath();
 
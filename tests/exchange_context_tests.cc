@@ -224,3 +224,26 @@ TEST_F(ExchangeContextTests, AddBid2) {
   bidders.insert(fac2);
   EXPECT_EQ(bidders, context.bidders);
 }
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+TEST_F(ExchangeContextTests, PrefView) {
+  ExchangeContext<Resource> context;
+  context.AddRequestPortfolio(rp1);
+  BidPortfolio<Resource>::Ptr bp(new BidPortfolio<Resource>());
+  Bid<Resource>* bid1 = bp->AddBid(req1, get_mat(), fac2);
+  Bid<Resource>* bid2 = bp->AddBid(req1, get_mat(), fac2);
+  context.AddBidPortfolio(bp);
+
+  PrefMap<Resource>::type& prefs = context.trader_prefs[fac1];
+  cyclus::PrefView<Resource> view(prefs);
+  ASSERT_EQ(2, view.size());
+  EXPECT_EQ(req1, view.requests[1]);
+  EXPECT_EQ(pref, *view.prefs[0]);
+
+  // preferences are adjusted in place
+  for (int i = 0; i < view.size(); ++i) {
+    *view.prefs[i] = view.bids[i] == bid2 ? 2 : 1;
+  }
+  EXPECT_EQ(1, prefs[req1][bid1]);
+  EXPECT_EQ(2, prefs[req1][bid2]);
+}
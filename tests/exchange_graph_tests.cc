@@ -20,6 +20,24 @@ TEST(ExGraphTests, ExchangeNodeGroups) {
   EXPECT_EQ(&s, n->group);
 }
 
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+TEST(ExGraphTests, ExclGroupMultiplicity) {
+  ExchangeNode::Ptr a(new ExchangeNode(1, true));
+  ExchangeNode::Ptr b(new ExchangeNode(1, true));
+  a->multiplicity = 3;
+  b->multiplicity = 3;
+  vector<ExchangeNode::Ptr> nodes;
+  nodes.push_back(a);
+  nodes.push_back(b);
+  ExchangeNodeGroup s;
+  s.AddExclGroup(nodes);
+  EXPECT_EQ(1, s.excl_node_groups().size());
+
+  b->multiplicity = 2;
+  EXPECT_THROW(s.AddExclGroup(nodes), cyclus::ValueError);
+  EXPECT_EQ(1, s.excl_node_groups().size());
+}
+
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 TEST(ExGraphTests, ReqGroups) {
   double q = 1.5;
@@ -130,3 +148,109 @@ TEST(ExGraphTests, AddMatch) {
   ASSERT_EQ(1, g.matches().size());
   EXPECT_EQ(match, g.matches().at(0));
 }
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+TEST(ExGraphTests, ConnectedComponents) {
+  // r0 - s0 - r2 form one component, r1 - s1 another, r3 and s2 have no arcs
+  ExchangeGraph g;
+  vector<RequestGroup::Ptr> rgs;
+  vector<ExchangeNodeGroup::Ptr> sgs;
+  vector<ExchangeNode::Ptr> us;
+  vector<ExchangeNode::Ptr> vs;
+  for (int i = 0; i < 4; ++i) {
+    rgs.push_back(RequestGroup::Ptr(new RequestGroup()));
+    us.push_back(ExchangeNode::Ptr(new ExchangeNode()));
+    rgs[i]->AddExchangeNode(us[i]);
+    g.AddRequestGroup(rgs[i]);
+  }
+  for (int i = 0; i < 3; ++i) {
+    sgs.push_back(ExchangeNodeGroup::Ptr(new ExchangeNodeGroup()));
+    vs.push_back(ExchangeNode::Ptr(new ExchangeNode()));
+    sgs[i]->AddExchangeNode(vs[i]);
+    g.AddSupplyGroup(sgs[i]);
+  }
+  Arc a0(us[0], vs[0]);
+  Arc a1(us[1], vs[1]);
+  Arc a2(us[2], vs[0]);
+  g.AddArc(a0);
+  g.AddArc(a1);
+  g.AddArc(a2);
+
+  vector<ExchangeGraph::Ptr> comps = g.ConnectedComponents();
+  ASSERT_EQ(2, comps.size());
+
+  ASSERT_EQ(2, comps[0]->request_groups().size());
+  EXPECT_EQ(rgs[0], comps[0]->request_groups()[0]);
+  EXPECT_EQ(rgs[2], comps[0]->request_groups()[1]);
+  ASSERT_EQ(1, comps[0]->supply_groups().size());
+  EXPECT_EQ(sgs[0], comps[0]->supply_groups()[0]);
+  ASSERT_EQ(2, comps[0]->arcs().size());
+  EXPECT_EQ(a0, comps[0]->arcs()[0]);
+  EXPECT_EQ(a2, comps[0]->arcs()[1]);
+  EXPECT_EQ(2, comps[0]->node_arc_map().at(vs[0]).size());
+
+  ASSERT_EQ(1, comps[1]->request_groups().size());
+  EXPECT_EQ(rgs[1], comps[1]->request_groups()[0]);
+  ASSERT_EQ(1, comps[1]->supply_groups().size());
+  EXPECT_EQ(sgs[1], comps[1]->supply_groups()[0]);
+  ASSERT_EQ(1, comps[1]->arcs().size());
+  EXPECT_EQ(a1, comps[1]->arcs()[0]);
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+TEST(ExGraphTests, Flat) {
+  ExchangeGraph g;
+  RequestGroup::Ptr r(new RequestGroup(1));
+  ExchangeNodeGroup::Ptr s(new ExchangeNodeGroup());
+  ExchangeNode::Ptr u0(new ExchangeNode(1));
+  ExchangeNode::Ptr u1(new ExchangeNode(1));
+  ExchangeNode::Ptr v(new ExchangeNode(2));
+  r->AddExchangeNode(u0);
+  r->AddExchangeNode(u1);
+  s->AddExchangeNode(v);
+  s->AddCapacity(3);
+  s->AddCapacity(4);
+  g.AddRequestGroup(r);
+  g.AddSupplyGroup(s);
+
+  Arc a0(u1, v);
+  Arc a1(u0, v);
+  u1->prefs[a0] = 2;
+  v->unit_capacities[a0].push_back(0.5);
+  v->unit_capacities[a0].push_back(0.25);
+  g.AddArc(a0);
+  g.AddArc(a1);
+
+  cyclus::FlatExchangeGraph f(g);
+  EXPECT_EQ(1, f.nreq);
+  ASSERT_EQ(2, f.groups.size());
+  EXPECT_EQ(s.get(), f.groups[1]);
+  ASSERT_EQ(3, f.nodes.size());
+  EXPECT_EQ(1, f.NodeId(u1.get()));
+  EXPECT_EQ(2, f.NodeId(v.get()));
+  EXPECT_EQ(-1, f.NodeId(NULL));
+  EXPECT_EQ(1, f.node_group[2]);
+  EXPECT_EQ(4, f.caps[f.cap_start[1] + 1]);
+
+  EXPECT_EQ(1, f.arc_u[0]);
+  EXPECT_EQ(2, f.arc_v[0]);
+  EXPECT_EQ(2, f.u_pref[0]);
+  EXPECT_EQ(0, f.u_pref[1]);
+  EXPECT_EQ(0, f.n_ucaps(0, true));
+  ASSERT_EQ(2, f.n_ucaps(0, false));
+  EXPECT_EQ(0.25, f.ucaps(0, false)[1]);
+  EXPECT_EQ(0, f.n_ucaps(1, false));
+
+  // the arcs of v are listed in the order they were added
+  ASSERT_EQ(2, f.adj_start[3] - f.adj_start[2]);
+  EXPECT_EQ(0, f.adj_arcs[f.adj_start[2]]);
+  EXPECT_EQ(1, f.adj_arcs[f.adj_start[2] + 1]);
+
+  // the compatibility maps agree with the arcs' indices
+  EXPECT_EQ(1, g.arc_ids().at(a1));
+  EXPECT_EQ(a0, g.arc_by_id().at(0));
+  ExchangeNode::Ptr w(new ExchangeNode());
+  g.AddArc(Arc(u0, w));
+  EXPECT_EQ(2, g.arc_ids().at(Arc(u0, w)));
+  EXPECT_THROW(cyclus::FlatExchangeGraph f2(g), cyclus::StateError);
+}
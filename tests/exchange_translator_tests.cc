@@ -9,6 +9,7 @@
 #include "exchange_graph.h"
 #include "exchange_translator.h"
 #include "exchange_translation_context.h"
+#include "greedy_solver.h"
 #include "equality_helpers.h"
 #include "material.h"
 #include "test_agents/test_facility.h"
@@ -30,6 +31,7 @@ using cyclus::ExchangeContext;
 using cyclus::ExchangeGraph;
 using cyclus::ExchangeTranslator;
 using cyclus::ExchangeTranslationContext;
+using cyclus::GreedySolver;
 using cyclus::Match;
 using cyclus::Material;
 using cyclus::ExchangeNode;
@@ -431,6 +433,12 @@ TEST(ExXlateTests, SimpleXlate) {
   EXPECT_EQ(0, graph->matches().size());
   const Arc& a = *graph->arcs().begin();
   EXPECT_EQ(pref, a.unode()->prefs[a]);
+
+  // a portfolio reused by a later exchange keeps a single mass constraint
+  ExchangeTranslator<Material> again(&ctx);
+  graph = again.Translate();
+  EXPECT_EQ(1, rport->constraints().size());
+  EXPECT_EQ(1, graph->request_groups()[0]->capacities().size());
 }
 
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
@@ -478,3 +486,49 @@ TEST(ExXlateTests, BackXlate) {
   xlator.BackTranslateSolution(matches, obs);
   EXPECT_EQ(exp, obs);
 }
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+TEST(ExXlateTests, Multiplicity) {
+  TestContext tc;
+  TestFacility* trader = tc.trader();
+
+  std::string commod = "c";
+  RequestPortfolio<Material>::Ptr rport(new RequestPortfolio<Material>());
+  Request<Material>* req = rport->AddRequest(get_mat(u235, qty), trader, commod);
+
+  // four units of which three fit into the request
+  double unit = qty / 3;
+  BidPortfolio<Material>::Ptr bport(new BidPortfolio<Material>());
+  Bid<Material>* bid = bport->AddBid(req, get_mat(u235, unit), trader, true,
+                                     std::numeric_limits<double>::quiet_NaN(),
+                                     4);
+  EXPECT_EQ(4, bid->multiplicity());
+  EXPECT_THROW(bport->AddBid(req, get_mat(u235, unit), trader, false,
+                             std::numeric_limits<double>::quiet_NaN(), 2),
+               cyclus::ValueError);
+
+  ExchangeContext<Material> ctx;
+  ctx.AddRequestPortfolio(rport);
+  ctx.AddBidPortfolio(bport);
+  ExchangeTranslator<Material> xlator(&ctx);
+  ExchangeGraph::Ptr graph = xlator.Translate();
+  ASSERT_EQ(1, graph->arcs().size());
+  const Arc& a = graph->arcs()[0];
+  EXPECT_EQ(4, a.vnode()->multiplicity);
+  EXPECT_EQ(4, a.excl_units());
+  EXPECT_DOUBLE_EQ(unit, a.excl_val());
+
+  GreedySolver solver;
+  solver.Solve(graph.get());
+  ASSERT_EQ(1, graph->matches().size());
+  EXPECT_NEAR(qty, graph->matches()[0].second, 1e-9);
+
+  // the match is expanded into one trade per unit
+  std::vector< Trade<Material> > obs;
+  xlator.BackTranslateSolution(graph->matches(), obs);
+  ASSERT_EQ(3, obs.size());
+  for (int i = 0; i < obs.size(); ++i) {
+    EXPECT_EQ(bid, obs[i].bid);
+    EXPECT_NEAR(unit, obs[i].amt, 1e-9);
+  }
+}
@@ -83,3 +83,82 @@ TEST(GreedySolverTests, General) {
   EXPECT_EQ(g.request_groups()[1], gu1);
   EXPECT_EQ(g.request_groups()[0], gu2);
 }
+
+//- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+// adds two requesters sharing one supplier of capacity qty to g
+static void AddMarket(ExchangeGraph* g, double qty) {
+  ExchangeNode::Ptr v(new ExchangeNode(qty));
+  ExchangeNodeGroup::Ptr gv(new ExchangeNodeGroup());
+  gv->AddExchangeNode(v);
+  gv->AddCapacity(qty);
+  g->AddSupplyGroup(gv);
+  for (int i = 0; i < 2; ++i) {
+    ExchangeNode::Ptr u(new ExchangeNode(qty / 2));
+    RequestGroup::Ptr gu(new RequestGroup(qty / 2));
+    gu->AddExchangeNode(u);
+    gu->AddCapacity(qty / 2);
+    g->AddRequestGroup(gu);
+    Arc a(u, v);
+    a.pref(i + 1);
+    u->prefs[a] = i + 1;
+    u->unit_capacities[a].push_back(1);
+    v->unit_capacities[a].push_back(1);
+    g->AddArc(a);
+  }
+}
+
+TEST(GreedySolverTests, Components) {
+  ExchangeGraph g;
+  AddMarket(&g, 2);
+  AddMarket(&g, 4);
+  AddMarket(&g, 6);
+  EXPECT_EQ(3, g.ConnectedComponents().size());
+
+  GreedySolver s(false);
+  s.nthreads(3);
+  EXPECT_EQ(3, s.nthreads());
+  double obj = s.Solve(&g);
+
+  // every request is satisfied by the supplier in its own market
+  ASSERT_EQ(6, g.matches().size());
+  double total = 0;
+  for (int i = 0; i < g.matches().size(); ++i) {
+    const Arc& a = g.matches()[i].first;
+    EXPECT_DOUBLE_EQ(a.unode()->qty, g.matches()[i].second);
+    total += g.matches()[i].second;
+  }
+  EXPECT_DOUBLE_EQ(12, total);
+  EXPECT_DOUBLE_EQ(0.5 + 1 + 1 + 2 + 1.5 + 3, obj);
+}
+
+//- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+TEST(GreedySolverTests, Multiplicity) {
+  // five exclusive units of 2 for a request of 7
+  ExchangeNode::Ptr u(new ExchangeNode(7));
+  ExchangeNode::Ptr v(new ExchangeNode(2, true));
+  v->multiplicity = 5;
+  RequestGroup::Ptr gu(new RequestGroup(7));
+  gu->AddExchangeNode(u);
+  gu->AddCapacity(7);
+  ExchangeNodeGroup::Ptr gv(new ExchangeNodeGroup());
+  gv->AddExchangeNode(v);
+  gv->AddCapacity(10);
+
+  Arc a(u, v);
+  EXPECT_EQ(5, a.excl_units());
+  EXPECT_EQ(2, a.excl_val());
+  a.pref(1);
+  u->prefs[a] = 1;
+  u->unit_capacities[a].push_back(1);
+  v->unit_capacities[a].push_back(1);
+
+  ExchangeGraph g;
+  g.AddRequestGroup(gu);
+  g.AddSupplyGroup(gv);
+  g.AddArc(a);
+
+  GreedySolver s;
+  s.Solve(&g);
+  ASSERT_EQ(1, g.matches().size());
+  EXPECT_DOUBLE_EQ(6, g.matches()[0].second);
+}
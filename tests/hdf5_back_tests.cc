@@ -254,3 +254,333 @@ TEST(Hdf5BackTest, Tables) {
   EXPECT_LE(1, tabs.size());
   EXPECT_EQ(1, tabs.count("IntTable"));
 }
+
+TEST(Hdf5BackTest, IndexedQuery) {
+  using cyclus::Cond;
+  using cyclus::QueryResult;
+  using cyclus::Recorder;
+  using cyclus::Hdf5Back;
+  FileDeleter fd(path);
+
+  // spans several chunks
+  Recorder m((unsigned int) 500);
+  Hdf5Back back(path);
+  m.RegisterBackend(&back);
+  for (int i = 0; i < 3000; ++i) {
+    m.NewDatum("Agents")
+        ->AddVal("AgentId", i % 100)
+        ->AddVal("SimTime", i / 100)
+        ->AddVal("val", 0.5 * i)
+        ->Record();
+  }
+  m.Flush();
+
+  std::vector<Cond> conds;
+  conds.push_back(Cond("AgentId", "==", 7));
+  conds.push_back(Cond("SimTime", ">=", 10));
+  conds.push_back(Cond("SimTime", "<", 20));
+  QueryResult qr = back.Query("Agents", &conds);
+  ASSERT_EQ(10, qr.rows.size());
+  for (int i = 0; i < qr.rows.size(); ++i) {
+    EXPECT_EQ(7, qr.GetVal<int>("AgentId", i));
+    EXPECT_EQ(10 + i, qr.GetVal<int>("SimTime", i));
+    EXPECT_DOUBLE_EQ(0.5 * (1000 + 100 * i + 7), qr.GetVal<double>("val", i));
+  }
+
+  // non-indexable conditions are still applied
+  conds.push_back(Cond("SimTime", "!=", 15));
+  conds.push_back(Cond("val", ">", 0.5 * 1200));
+  EXPECT_EQ(7, back.Query("Agents", &conds).rows.size());
+
+  // indexes are refreshed after writes
+  m.NewDatum("Agents")
+      ->AddVal("AgentId", 7)
+      ->AddVal("SimTime", 12)
+      ->AddVal("val", 1.0)
+      ->Record();
+  m.Close();
+  conds.resize(1);
+  conds.push_back(Cond("SimTime", "==", 12));
+  EXPECT_EQ(2, back.Query("Agents", &conds).rows.size());
+}
+
+TEST(Hdf5BackTest, Cursor) {
+  using cyclus::Cond;
+  using cyclus::QueryCursor;
+  using cyclus::QueryResult;
+  using cyclus::Recorder;
+  using cyclus::Hdf5Back;
+  FileDeleter fd(path);
+
+  Recorder m((unsigned int) 500);
+  Hdf5Back back(path);
+  back.set_chunk_bytes(1000);
+  m.RegisterBackend(&back);
+  for (int i = 0; i < 1000; ++i) {
+    m.NewDatum("Agents")
+        ->AddVal("AgentId", i % 10)
+        ->AddVal("name", std::string(i % 2 ? "odd" : "even"))
+        ->Record();
+  }
+  m.Flush();
+
+  // batches cut across chunks and conditions drop rows within chunks
+  std::vector<Cond> conds;
+  conds.push_back(Cond("AgentId", "<", 5));
+  conds.push_back(Cond("name", "==", std::string("odd")));
+  QueryCursor::Ptr c = back.Cursor("Agents", &conds);
+  QueryResult qr;
+  int nrows = 0;
+  int nbatches = 0;
+  while (c->Fetch(7, &qr)) {
+    EXPECT_GE(7, qr.rows.size());
+    for (int i = 0; i < qr.rows.size(); ++i) {
+      EXPECT_EQ(1, qr.GetVal<int>("AgentId", i) % 2);
+      EXPECT_EQ("odd", qr.GetVal<std::string>("name", i));
+    }
+    nrows += qr.rows.size();
+    ++nbatches;
+  }
+  EXPECT_EQ(200, nrows);
+  EXPECT_EQ(29, nbatches);
+  EXPECT_EQ(200, back.Query("Agents", &conds).rows.size());
+
+  // the rows are selected when the cursor is created
+  c = back.Cursor("Agents", NULL);
+  m.NewDatum("Agents")
+      ->AddVal("AgentId", 1)
+      ->AddVal("name", std::string("odd"))
+      ->Record();
+  m.Close();
+  EXPECT_TRUE(c->Fetch(2000, &qr));
+  EXPECT_EQ(1000, qr.rows.size());
+  EXPECT_EQ(1001, back.Query("Agents", NULL).rows.size());
+  EXPECT_THROW(back.Cursor("Missing", NULL), cyclus::IOError);
+}
+
+TEST(Hdf5BackTest, Projection) {
+  using cyclus::Cond;
+  using cyclus::QueryResult;
+  using cyclus::Recorder;
+  using cyclus::Hdf5Back;
+  FileDeleter fd(path);
+
+  Recorder m((unsigned int) 100);
+  Hdf5Back back(path);
+  m.RegisterBackend(&back);
+  for (int i = 0; i < 20; ++i) {
+    m.NewDatum("Agents")
+        ->AddVal("AgentId", i)
+        ->AddVal("name", std::string(i % 2 ? "odd" : "even"))
+        ->AddVal("mass", 0.5 * i)
+        ->Record();
+  }
+  m.Close();
+
+  // the condition's column is decoded but not returned
+  std::vector<Cond> conds;
+  conds.push_back(Cond("name", "==", std::string("odd")));
+  std::vector<std::string> cols;
+  cols.push_back("mass");
+  cols.push_back("AgentId");
+  QueryResult qr = back.Query("Agents", &conds, &cols);
+  EXPECT_EQ(cols, qr.fields);
+  EXPECT_EQ(cyclus::DOUBLE, qr.types[0]);
+  ASSERT_EQ(10, qr.rows.size());
+  ASSERT_EQ(2, qr.rows[0].size());
+  EXPECT_EQ(3, qr.GetVal<int>("AgentId", 1));
+  EXPECT_DOUBLE_EQ(1.5, qr.GetVal<double>("mass", 1));
+
+  cyclus::ColumnarResult cr = back.QueryColumns("Agents", NULL, &cols);
+  ASSERT_EQ(2, cr.columns.size());
+  EXPECT_EQ(20, cr.nrows);
+  EXPECT_EQ(19, cr.column("AgentId").ints[19]);
+
+  ASSERT_TRUE(back.Cursor("Agents", &conds, &cols)->Fetch(4, &qr));
+  EXPECT_EQ(4, qr.rows.size());
+  EXPECT_EQ(cols, qr.fields);
+
+  // rejected columns don't leave the table's dataset open
+  ssize_t nopen = H5Fget_obj_count(H5F_OBJ_ALL, H5F_OBJ_DATASET);
+  cols.push_back("foo");
+  EXPECT_THROW(back.Query("Agents", NULL, &cols), cyclus::KeyError);
+  cols.clear();
+  EXPECT_THROW(back.Query("Agents", NULL, &cols), cyclus::ValueError);
+  EXPECT_EQ(nopen, H5Fget_obj_count(H5F_OBJ_ALL, H5F_OBJ_DATASET));
+}
+
+TEST(Hdf5BackTest, CompressionAndChunks) {
+  using cyclus::Recorder;
+  using cyclus::Hdf5Back;
+  FileDeleter fd(path);
+  {
+    Recorder m((unsigned int) 100);
+    Hdf5Back back(path);
+    EXPECT_THROW(back.set_compression("gzip"), cyclus::ValueError);
+    back.set_compression("shuffle, deflate:4");
+    back.set_chunk_bytes(1000);
+    back.set_expected_rows("Small", 3);
+    m.RegisterBackend(&back);
+    for (int i = 0; i < 250; ++i) {
+      m.NewDatum("Big")
+          ->AddVal("x", i)
+          ->AddVal("name", std::string(i % 2 ? "odd" : "even"))
+          ->AddVal("label", std::string("label") + std::to_string(i))
+          ->Record();
+    }
+    m.NewDatum("Small")->AddVal("x", 1)->Record();
+    m.Close();
+    back.Close();
+  }
+
+  hid_t file = H5Fopen(path, H5F_ACC_RDONLY, H5P_DEFAULT);
+  hid_t dset = H5Dopen2(file, "Big", H5P_DEFAULT);
+  hid_t plist = H5Dget_create_plist(dset);
+  hsize_t chunk;
+  H5Pget_chunk(plist, 1, &chunk);
+  EXPECT_GT(1000 / 20, chunk);
+  ASSERT_EQ(2, H5Pget_nfilters(plist));
+  unsigned int flags;
+  size_t nelmts = 1;
+  unsigned int level;
+  EXPECT_EQ(H5Z_FILTER_SHUFFLE,
+            H5Pget_filter2(plist, 0, &flags, &nelmts, &level, 0, NULL, NULL));
+  nelmts = 1;
+  EXPECT_EQ(H5Z_FILTER_DEFLATE,
+            H5Pget_filter2(plist, 1, &flags, &nelmts, &level, 0, NULL, NULL));
+  EXPECT_EQ(4, level);
+  H5Pclose(plist);
+  H5Dclose(dset);
+
+  dset = H5Dopen2(file, "Small", H5P_DEFAULT);
+  plist = H5Dget_create_plist(dset);
+  H5Pget_chunk(plist, 1, &chunk);
+  EXPECT_EQ(3, chunk);
+  H5Pclose(plist);
+  H5Dclose(dset);
+
+  // one key per distinct string, written in batches
+  dset = H5Dopen2(file, "StringKeys", H5P_DEFAULT);
+  hid_t space = H5Dget_space(dset);
+  EXPECT_EQ(252, H5Sget_simple_extent_npoints(space));
+  H5Sclose(space);
+  H5Dclose(dset);
+  H5Fclose(file);
+
+  Hdf5Back back(path);
+  cyclus::QueryResult qr = back.Query("Big", NULL);
+  ASSERT_EQ(250, qr.rows.size());
+  EXPECT_EQ("odd", qr.GetVal<std::string>("name", 249));
+  EXPECT_EQ("label249", qr.GetVal<std::string>("label", 249));
+}
+
+static hsize_t NumStringKeys(const char* fname) {
+  hid_t file = H5Fopen(fname, H5F_ACC_RDONLY, H5P_DEFAULT);
+  hid_t dset = H5Dopen2(file, "StringKeys", H5P_DEFAULT);
+  hid_t space = H5Dget_space(dset);
+  hsize_t n = H5Sget_simple_extent_npoints(space);
+  H5Sclose(space);
+  H5Dclose(dset);
+  H5Fclose(file);
+  return n;
+}
+
+TEST(Hdf5BackTest, VLKeyCache) {
+  using cyclus::Recorder;
+  using cyclus::Hdf5Back;
+  FileDeleter fd(path);
+  {
+    Recorder m((unsigned int) 50);
+    Hdf5Back back(path);
+    // a tiny Bloom filter and LRU list force keys to be checked on disk
+    back.set_vl_cache(64, 2);
+    m.RegisterBackend(&back);
+    for (int i = 0; i < 200; ++i) {
+      m.NewDatum("Names")
+          ->AddVal("name", std::string("name") + std::to_string(i % 40))
+          ->Record();
+    }
+    m.Close();
+    Hdf5Back::VLCacheStats stats = back.vl_cache_stats();
+#if H5_VERSION_GE(1, 10, 5)
+    EXPECT_LT(0, stats.probes);
+    EXPECT_LT(0, stats.probe_hits);
+#else
+    EXPECT_EQ(0, stats.probes);
+#endif
+    EXPECT_EQ(200, stats.hits + stats.absent + stats.probes);
+    back.Close();
+  }
+  EXPECT_EQ(40, NumStringKeys(path));
+
+  // keys already in the file are found after reopening it
+  {
+    Recorder m((unsigned int) 50);
+    Hdf5Back back(path);
+    m.RegisterBackend(&back);
+    m.NewDatum("Names")->AddVal("name", std::string("name7"))->Record();
+    m.NewDatum("Names")->AddVal("name", std::string("name7"))->Record();
+    m.NewDatum("Names")->AddVal("name", std::string("new"))->Record();
+    m.Close();
+    EXPECT_EQ(1, back.vl_cache_stats().str_hits);
+    cyclus::QueryResult qr = back.Query("Names", NULL);
+    ASSERT_EQ(203, qr.rows.size());
+    EXPECT_EQ("name39", qr.GetVal<std::string>("name", 199));
+    EXPECT_EQ("new", qr.GetVal<std::string>("name", 202));
+    back.Close();
+  }
+  EXPECT_EQ(41, NumStringKeys(path));
+}
+
+TEST(Hdf5BackTest, VLKeyCacheExact) {
+  cyclus::Sha1 hasher;
+  std::vector<cyclus::Digest> keys;
+  for (int i = 0; i < 41; ++i) {
+    hasher.Clear();
+    hasher.Update(std::to_string(i));
+    keys.push_back(hasher.digest());
+  }
+
+  // a full Bloom filter and a short LRU list can't tell which keys are stored
+  cyclus::VLKeyCache exact(64, 2, true);
+  cyclus::VLKeyCache bounded(64, 2);
+  for (int i = 0; i < 40; ++i) {
+    exact.Insert(keys[i]);
+    bounded.Insert(keys[i]);
+  }
+  for (int i = 0; i < 40; ++i) {
+    EXPECT_EQ(cyclus::VLKeyCache::PRESENT, exact.Find(keys[i]));
+  }
+  EXPECT_EQ(cyclus::VLKeyCache::ABSENT, exact.Find(keys[40]));
+  EXPECT_EQ(0, exact.maybe());
+  EXPECT_EQ(cyclus::VLKeyCache::MAYBE, bounded.Find(keys[0]));
+}
+
+TEST(Hdf5BackTest, VLHashCache) {
+  using cyclus::Recorder;
+  using cyclus::Hdf5Back;
+  FileDeleter fd(path);
+  Recorder m((unsigned int) 50);
+  Hdf5Back back(path);
+  // room for the digests of four short strings, long ones aren't cached
+  back.set_vl_cache(1 << 22, 4096, 400);
+  m.RegisterBackend(&back);
+  const char* names[] = {"a", "b", "c", "d", "a", "e", "a", "b", "d"};
+  for (int i = 0; i < 9; ++i) {
+    m.NewDatum("Names")->AddVal("name", std::string(names[i]))->Record();
+  }
+  for (int i = 0; i < 2; ++i) {
+    m.NewDatum("Names")->AddVal("name", std::string(5000, 'x'))->Record();
+  }
+  m.Close();
+
+  // the second a and the third a are hits, e evicts b (the least recently
+  // used) and b then evicts c, leaving d cached
+  EXPECT_EQ(3, back.vl_cache_stats().str_hits);
+  cyclus::QueryResult qr = back.Query("Names", NULL);
+  ASSERT_EQ(11, qr.rows.size());
+  EXPECT_EQ("d", qr.GetVal<std::string>("name", 8));
+  EXPECT_EQ(5000, qr.GetVal<std::string>("name", 10).size());
+  back.Close();
+  EXPECT_EQ(6, NumStringKeys(path));
+}
@@ -227,6 +227,27 @@ TEST_F(MaterialTest, DecayManual) {
   EXPECT_NE(am241_qty, mq.mass(am241_));
 }
 
+TEST_F(MaterialTest, DecayMany) {
+  Material::Ptr m1 = tracked_mat_->ExtractQty(1);
+  Material::Ptr m2 = tracked_mat_->ExtractQty(1);
+  Material::Ptr m3 = tracked_mat_->ExtractQty(1);
+
+  std::vector<Material::Ptr> mats;
+  mats.push_back(m1);
+  mats.push_back(m2);
+  mats.push_back(m1);  // duplicates are decayed only once
+  mats.push_back(tracked_mat_no_decay_);
+  Material::DecayMany(mats, 100);
+  m3->Decay(100);
+
+  EXPECT_EQ(100, m1->prev_decay_time());
+  EXPECT_EQ(100, m2->prev_decay_time());
+  EXPECT_EQ(0, tracked_mat_no_decay_->prev_decay_time());
+  EXPECT_EQ(m3->comp(), m1->comp());
+  EXPECT_EQ(m3->comp(), m2->comp());
+  EXPECT_EQ(diff_comp_, tracked_mat_no_decay_->comp());
+}
+
 TEST_F(MaterialTest, DecayLazy) {
   SimInfo si(100, 2015, 1, "", "lazy");
   cyclus::Context ctx(&ti, &rec);
@@ -258,6 +279,29 @@ TEST_F(MaterialTest, DecayLazy) {
   EXPECT_NE(am241_qty, mq.mass(am241_));
 }
 
+TEST_F(MaterialTest, DecayedComps) {
+  SimInfo si(100, 2015, 1, "", "lazy");
+  cyclus::Context ctx(&ti, &rec);
+  ctx.InitSim(si);
+  Agent* a = new TestFacility(&ctx);
+  std::vector<Material::Ptr> mats;
+  mats.push_back(Material::Create(a, 1000, diff_comp_));
+  mats.push_back(Material::Create(a, 10, diff_comp_));
+  mats.push_back(test_mat_);  // untracked materials never decay lazily
+  ti.RunSim();
+
+  std::vector<cyclus::Composition::Ptr> comps = Material::DecayedComps(mats);
+  ASSERT_EQ(3, comps.size());
+  EXPECT_NE(diff_comp_, comps[0]);
+  EXPECT_EQ(comps[0], comps[1]);
+  EXPECT_EQ(mats[0]->DecayedComp(), comps[0]);
+  EXPECT_EQ(test_mat_->comp(), comps[2]);
+
+  // the materials themselves are left as they are
+  EXPECT_EQ(0, mats[0]->prev_decay_time());
+  EXPECT_EQ(0, mats[1]->prev_decay_time());
+}
+
 TEST_F(MaterialTest, DecayDefault) {
   cyclus::toolkit::MatQuery orig(tracked_mat_);
   double u235_qty = orig.mass(u235_);
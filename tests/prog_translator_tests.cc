@@ -12,6 +12,7 @@
 #include "equality_helpers.h"
 #include "exchange_graph.h"
 #include "logger.h"
+#include "prog_solver.h"
 #include "prog_translator.h"
 #include "solver_factory.h"
 #include "env.h"
@@ -279,6 +280,94 @@ TEST(ProgTranslatorTests, translation) {
   delete iface;
 }
 
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+// two requesters (agents 1 and 2) of qty 1 and one supplier (agent 3) of qty
+// supply
+static void BuildWarmGraph(ExchangeGraph* g, double supply) {
+  ExchangeNode::Ptr v(new ExchangeNode(supply, false, "commod", 3));
+  ExchangeNodeGroup::Ptr gv(new ExchangeNodeGroup());
+  gv->AddExchangeNode(v);
+  gv->AddCapacity(supply);
+  g->AddSupplyGroup(gv);
+  for (int i = 1; i <= 2; ++i) {
+    ExchangeNode::Ptr u(new ExchangeNode(1, false, "commod", i));
+    RequestGroup::Ptr gu(new RequestGroup(1));
+    gu->AddExchangeNode(u);
+    gu->AddCapacity(1);
+    g->AddRequestGroup(gu);
+    Arc a(u, v);
+    a.pref(i);
+    u->prefs[a] = i;
+    u->unit_capacities[a].push_back(1);
+    v->unit_capacities[a].push_back(1);
+    g->AddArc(a);
+  }
+}
+
+TEST(ProgTranslatorTests, ColKeys) {
+  ExchangeGraph g;
+  BuildWarmGraph(&g, 1.5);
+  std::vector<ProgColKey> keys = ProgSolver::ColKeys(&g);
+  ASSERT_EQ(4, keys.size());
+  EXPECT_EQ(1, keys[0].req);
+  EXPECT_EQ(3, keys[0].bid);
+  EXPECT_EQ("commod", keys[0].commod);
+  EXPECT_EQ(2, keys[1].req);
+  EXPECT_EQ(1, keys[2].req);  // faux arcs
+  EXPECT_EQ(-1, keys[2].bid);
+  EXPECT_EQ(2, keys[3].req);
+  EXPECT_EQ(0, keys[3].n);
+}
+
+TEST(ProgTranslatorTests, WarmStart) {
+  ProgSolver cold("clp", false);
+  ProgSolver warm("clp", false);
+  warm.warm_start(true);
+  EXPECT_TRUE(warm.warm_start());
+
+  double supplies[] = {1.5, 1.5, 2, 0.5};
+  for (int i = 0; i < 4; ++i) {
+    ExchangeGraph gc;
+    BuildWarmGraph(&gc, supplies[i]);
+    double cold_obj = cold.Solve(&gc);
+    ExchangeGraph gw;
+    BuildWarmGraph(&gw, supplies[i]);
+    double warm_obj = warm.Solve(&gw);
+
+    EXPECT_DOUBLE_EQ(cold_obj, warm_obj);
+    ASSERT_EQ(gc.matches().size(), gw.matches().size());
+    for (int j = 0; j < gc.matches().size(); ++j) {
+      EXPECT_EQ(gc.matches()[j].first.unode()->agent_id,
+                gw.matches()[j].first.unode()->agent_id);
+      EXPECT_DOUBLE_EQ(gc.matches()[j].second, gw.matches()[j].second);
+    }
+  }
+}
+
+TEST(ProgTranslatorTests, WarmStartComponents) {
+  // the two components are solved by the solver and its clone, and both
+  // update the remembered basis
+  ProgSolver cold("clp", false);
+  ProgSolver warm("clp", false);
+  warm.warm_start(true);
+  warm.nthreads(2);
+
+  double supplies[] = {1.5, 1.5, 2, 0.5};
+  for (int i = 0; i < 4; ++i) {
+    ExchangeGraph gc;
+    BuildWarmGraph(&gc, supplies[i]);
+    BuildWarmGraph(&gc, supplies[i]);
+    double cold_obj = cold.Solve(&gc);
+    ExchangeGraph gw;
+    BuildWarmGraph(&gw, supplies[i]);
+    BuildWarmGraph(&gw, supplies[i]);
+    double warm_obj = warm.Solve(&gw);
+
+    EXPECT_NEAR(cold_obj, warm_obj, 1e-9);
+    EXPECT_EQ(gc.matches().size(), gw.matches().size());
+  }
+}
+
 TEST(ProgTranslatorTests, depricated) {
 
   // confirm depricated error is thrown
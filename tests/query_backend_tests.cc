@@ -128,3 +128,99 @@ TEST(QueryBackendTest, CmpConds) {
   EXPECT_PRED2(CmpConds<int>, &x, &conds);
   EXPECT_PRED2(NotCmpConds<int>, &y, &conds);
 }
+
+TEST(QueryBackendTest, ColumnarResult) {
+  cyclus::QueryResult qr;
+  qr.fields.push_back("n");
+  qr.types.push_back(cyclus::INT);
+  qr.fields.push_back("name");
+  qr.types.push_back(cyclus::STRING);
+  qr.fields.push_back("blob");
+  qr.types.push_back(cyclus::BLOB);
+  const char* names[] = {"a", "b", "a"};
+  for (int i = 0; i < 3; ++i) {
+    cyclus::QueryRow r;
+    r.push_back(boost::spirit::hold_any(i));
+    r.push_back(boost::spirit::hold_any(std::string(names[i])));
+    r.push_back(boost::spirit::hold_any(cyclus::Blob(names[i])));
+    qr.rows.push_back(r);
+  }
+
+  cyclus::ColumnarResult cr(qr);
+  EXPECT_EQ(3, cr.nrows);
+  ASSERT_EQ(3, cr.columns.size());
+  EXPECT_EQ(2, cr.column("n").ints[2]);
+
+  cyclus::QueryColumn& c = cr.column("name");
+  ASSERT_EQ(2, c.strs.size());
+  ASSERT_EQ(3, c.codes.size());
+  EXPECT_EQ(c.codes[0], c.codes[2]);
+  EXPECT_EQ("b", c.strs[c.codes[1]]);
+  EXPECT_EQ("a", cr.column("blob").vals[2].cast<cyclus::Blob>().str());
+  EXPECT_THROW(cr.column("foo"), cyclus::KeyError);
+}
+
+TEST(QueryBackendTest, ResultCursor) {
+  cyclus::QueryResult qr;
+  qr.fields.push_back("n");
+  qr.types.push_back(cyclus::INT);
+  for (int i = 0; i < 5; ++i) {
+    cyclus::QueryRow r;
+    r.push_back(boost::spirit::hold_any(i));
+    qr.rows.push_back(r);
+  }
+
+  cyclus::ResultCursor c(qr);
+  cyclus::QueryResult batch;
+  ASSERT_TRUE(c.Fetch(2, &batch));
+  EXPECT_EQ(qr.fields, batch.fields);
+  ASSERT_EQ(2, batch.rows.size());
+  EXPECT_EQ(1, batch.GetVal<int>("n", 1));
+  ASSERT_TRUE(c.Fetch(2, &batch));
+  EXPECT_EQ(2, batch.GetVal<int>("n", 0));
+  ASSERT_TRUE(c.Fetch(2, &batch));
+  ASSERT_EQ(1, batch.rows.size());
+  EXPECT_EQ(4, batch.GetVal<int>("n", 0));
+  EXPECT_FALSE(c.Fetch(2, &batch));
+  EXPECT_EQ(0, batch.rows.size());
+}
+
+TEST(QueryBackendTest, Project) {
+  cyclus::QueryResult qr;
+  qr.fields.push_back("n");
+  qr.types.push_back(cyclus::INT);
+  qr.fields.push_back("name");
+  qr.types.push_back(cyclus::STRING);
+  qr.fields.push_back("x");
+  qr.types.push_back(cyclus::DOUBLE);
+  for (int i = 0; i < 3; ++i) {
+    cyclus::QueryRow r;
+    r.push_back(boost::spirit::hold_any(i));
+    r.push_back(boost::spirit::hold_any(std::string("a")));
+    r.push_back(boost::spirit::hold_any(0.5 * i));
+    qr.rows.push_back(r);
+  }
+  cyclus::ColumnarResult cr(qr);
+
+  std::vector<std::string> cols;
+  cols.push_back("x");
+  cols.push_back("n");
+  qr.Project(cols);
+  EXPECT_EQ(cols, qr.fields);
+  EXPECT_EQ(cyclus::DOUBLE, qr.types[0]);
+  ASSERT_EQ(2, qr.rows[2].size());
+  EXPECT_DOUBLE_EQ(1.0, qr.GetVal<double>("x", 2));
+  EXPECT_EQ(2, qr.GetVal<int>("n", 2));
+
+  cr.Project(cols);
+  ASSERT_EQ(2, cr.columns.size());
+  EXPECT_EQ("x", cr.columns[0].field);
+  EXPECT_EQ(1, cr.column("n").ints[1]);
+
+  cols.push_back("foo");
+  EXPECT_THROW(qr.Project(cols), cyclus::KeyError);
+  EXPECT_THROW(cr.Project(cols), cyclus::KeyError);
+  cols.clear();
+  EXPECT_THROW(qr.Project(cols), cyclus::ValueError);
+  EXPECT_THROW(cr.Project(cols), cyclus::ValueError);
+}
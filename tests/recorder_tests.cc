@@ -1,5 +1,8 @@
+#include <stdexcept>
+
 #include <gtest/gtest.h>
 
+#include "parallel.h"
 #include "rec_backend.h"
 #include "recorder.h"
 
@@ -163,6 +166,138 @@ TEST(RecorderTest, Manager_CloseFlushing) {
   EXPECT_EQ(back1.notify_count, 1);
 }
 
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+TEST(RecorderTest, Manager_AsyncBuffering) {
+  using cyclus::Recorder;
+  TestBack back1;
+
+  Recorder m;
+  m.set_dump_count(2);
+  m.set_async(true);
+  EXPECT_TRUE(m.async());
+  m.RegisterBackend(&back1);
+
+  for (int i = 0; i < 5; ++i) {
+    m.NewDatum("DumbTitle")
+        ->AddVal("count", i)
+        ->Record();
+  }
+
+  // two full buffers were handed to the writer, one datum is still buffered
+  m.Flush();
+  EXPECT_EQ(back1.notify_count, 3);
+  EXPECT_EQ(back1.flush_count, 1);
+  EXPECT_TRUE(back1.flushed);
+  EXPECT_EQ(back1.data[0]->vals().back().second.cast<int>(), 4);
+
+  m.Close();
+  EXPECT_FALSE(m.async());
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+class ThrowBack : public TestBack {
+ public:
+  virtual void Notify(cyclus::DatumList data) {
+    throw cyclus::IOError("backend failure");
+  }
+};
+
+TEST(RecorderTest, Manager_AsyncError) {
+  using cyclus::Recorder;
+  ThrowBack back1;
+
+  Recorder m;
+  m.set_dump_count(1);
+  m.set_async(true);
+  m.RegisterBackend(&back1);
+
+  m.NewDatum("DumbTitle")
+      ->AddVal("animal", std::string("monkey"))
+      ->Record();
+  EXPECT_THROW(m.Flush(), cyclus::IOError);
+  m.Close();
+}
+
+class StdThrowBack : public TestBack {
+ public:
+  virtual void Notify(cyclus::DatumList data) {
+    throw std::runtime_error("backend failure");
+  }
+};
+
+TEST(RecorderTest, Manager_DestructorError) {
+  using cyclus::Recorder;
+  StdThrowBack back1;
+
+  // failures of any kind while flushing are logged, not thrown
+  EXPECT_NO_THROW({
+    Recorder m;
+    m.set_dump_count(2);
+    m.RegisterBackend(&back1);
+    m.NewDatum("DumbTitle")
+        ->AddVal("animal", std::string("monkey"))
+        ->Record();
+  });
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+TEST(RecorderTest, Manager_OpenDatum) {
+  using cyclus::Datum;
+  using cyclus::Recorder;
+  TestBack back1;
+
+  Recorder m;
+  m.set_dump_count(1);
+  m.RegisterBackend(&back1);
+
+  Datum* d1 = m.NewDatum("DumbTitle");
+  Datum* d2 = m.NewDatum("DumbTitle");
+  EXPECT_NE(d1, d2);
+  d1->AddVal("animal", std::string("monkey"))->Record();
+  EXPECT_EQ(back1.notify_count, 0);
+
+  d2->AddVal("animal", std::string("gorilla"))->Record();
+  EXPECT_EQ(back1.notify_count, 1);
+  EXPECT_EQ(back1.flush_count, 2);
+
+  m.NewDatum("DumbTitle")
+      ->AddVal("animal", std::string("lemur"))
+      ->Record();
+  EXPECT_EQ(back1.notify_count, 2);
+  EXPECT_EQ(back1.flush_count, 1);
+  m.Close();
+}
+
+class CountBack : public TestBack {
+ public:
+  CountBack() : nrows(0) {}
+
+  virtual void Notify(cyclus::DatumList data) {
+    nrows += data.size();
+    TestBack::Notify(data);
+  }
+
+  int nrows;
+};
+
+TEST(RecorderTest, Manager_Threaded) {
+  using cyclus::Recorder;
+  CountBack back1;
+
+  Recorder m;
+  m.set_dump_count(7);
+  m.RegisterBackend(&back1);
+
+  cyclus::ParallelFor(1000, 4, [&m](int i, int thread) {
+    m.NewDatum("DumbTitle")
+        ->AddVal("i", i)
+        ->AddVal("thread", thread)
+        ->Record();
+  });
+  m.Close();
+  EXPECT_EQ(back1.nrows, 1000);
+}
+
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 TEST(RecorderTest, Datum_record) {
   using cyclus::Datum;
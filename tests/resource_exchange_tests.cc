@@ -1,3 +1,4 @@
+#include <atomic>
 #include <set>
 #include <string>
 #include <math.h>
@@ -322,3 +323,256 @@ TEST_F(ResourceExchangeTests, PrefValues) {
   child->Decommission();
   parent->Decommission();
 }
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+class SafeRequester: public Requester {
+ public:
+  SafeRequester(Context* ctx) : Requester(ctx) {}
+
+  virtual cyclus::Agent* Clone() {
+    SafeRequester* m = new SafeRequester(context());
+    m->InitFrom(this);
+    m->port_ = port_;
+    return m;
+  }
+
+  virtual bool ThreadSafeExchange() { return true; }
+};
+
+class SafeBidder: public Bidder {
+ public:
+  SafeBidder(Context* ctx, std::string commod) : Bidder(ctx, commod) {}
+
+  virtual cyclus::Agent* Clone() {
+    SafeBidder* m = new SafeBidder(context(), commod_);
+    m->InitFrom(this);
+    m->port_ = port_;
+    return m;
+  }
+
+  virtual bool ThreadSafeExchange() { return true; }
+};
+
+TEST_F(ResourceExchangeTests, ThreadedMatchesSerial) {
+  SafeRequester* safereqr = new SafeRequester(tc.get());
+  SafeBidder* safebidr = new SafeBidder(tc.get(), commod);
+
+  // a mix of thread safe and serial traders
+  std::vector<Facility*> facs;
+  for (int i = 0; i < 12; ++i) {
+    Facility* f;
+    if (i % 3 == 0) {
+      f = dynamic_cast<Facility*>(reqr->Clone());
+    } else {
+      f = dynamic_cast<Facility*>(safereqr->Clone());
+    }
+    f->Build(NULL);
+    Requester* r = dynamic_cast<Requester*>(f);
+    r->port_ = RequestPortfolio<Material>::Ptr(
+        new RequestPortfolio<Material>());
+    Request<Material>* rq = r->port_->AddRequest(mat, r, commod, pref);
+
+    Facility* b = dynamic_cast<Facility*>(safebidr->Clone());
+    b->Build(NULL);
+    Bidder* bd = dynamic_cast<Bidder*>(b);
+    bd->port_ = BidPortfolio<Material>::Ptr(new BidPortfolio<Material>());
+    bd->port_->AddBid(rq, mat, bd);
+
+    facs.push_back(f);
+    facs.push_back(b);
+  }
+
+  ResourceExchange<Material> serial(tc.get());
+  serial.AddAllRequests();
+  serial.AddAllBids();
+
+  ResourceExchange<Material> threaded(tc.get());
+  threaded.nthreads(4);
+  EXPECT_EQ(4, threaded.nthreads());
+  threaded.AddAllRequests();
+  threaded.AddAllBids();
+
+  ExchangeContext<Material>& sctx = serial.ex_ctx();
+  ExchangeContext<Material>& tctx = threaded.ex_ctx();
+  EXPECT_EQ(12, tctx.requests.size());
+  EXPECT_EQ(12, tctx.bids.size());
+  EXPECT_EQ(sctx.requests, tctx.requests);
+  EXPECT_EQ(sctx.bids, tctx.bids);
+  EXPECT_EQ(sctx.commod_requests, tctx.commod_requests);
+  EXPECT_EQ(sctx.bids_by_request, tctx.bids_by_request);
+
+  for (int i = 0; i < facs.size(); ++i) {
+    facs[i]->Decommission();
+  }
+  delete safereqr;
+  delete safebidr;
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+class StaticRequester: public Requester {
+ public:
+  StaticRequester(Context* ctx) : Requester(ctx) {}
+
+  virtual cyclus::Agent* Clone() {
+    StaticRequester* m = new StaticRequester(context());
+    m->InitFrom(this);
+    return m;
+  }
+
+  virtual bool MatlRequestsUnchanged() { return true; }
+};
+
+class StaticBidder: public Bidder {
+ public:
+  StaticBidder(Context* ctx, std::string commod) : Bidder(ctx, commod) {}
+
+  virtual cyclus::Agent* Clone() {
+    StaticBidder* m = new StaticBidder(context(), commod_);
+    m->InitFrom(this);
+    return m;
+  }
+
+  virtual bool MatlBidsUnchanged() { return true; }
+};
+
+TEST_F(ResourceExchangeTests, ReuseUnchanged) {
+  StaticRequester* sreqr_proto = new StaticRequester(tc.get());
+  StaticBidder* sbidr_proto = new StaticBidder(tc.get(), commod);
+  Bidder* bidr_proto = new Bidder(tc.get(), commod);
+  Requester* sreqr = dynamic_cast<Requester*>(sreqr_proto->Clone());
+  Requester* reqr2 = dynamic_cast<Requester*>(reqr->Clone());
+  Bidder* sbidr = dynamic_cast<Bidder*>(sbidr_proto->Clone());
+  Bidder* bidr2 = dynamic_cast<Bidder*>(bidr_proto->Clone());
+  Facility* facs[] = {sreqr, reqr2, sbidr, bidr2};
+  for (int i = 0; i < 4; ++i) {
+    facs[i]->Build(NULL);
+  }
+
+  sreqr->port_.reset(new RequestPortfolio<Material>());
+  Request<Material>* sreq = sreqr->port_->AddRequest(mat, sreqr, commod);
+  reqr2->port_.reset(new RequestPortfolio<Material>());
+  req = reqr2->port_->AddRequest(mat, reqr2, commod);
+  sbidr->port_.reset(new BidPortfolio<Material>());
+  sbidr->port_->AddBid(sreq, mat, sbidr);
+  bidr2->port_.reset(new BidPortfolio<Material>());
+  bidr2->port_->AddBid(req, mat, bidr2);
+
+  ResourceExchange<Material> first(tc.get());
+  first.AddAllRequests();
+  first.AddAllBids();
+  EXPECT_EQ(2, first.history().requests.size());
+  EXPECT_EQ(2, first.history().bids.size());
+
+  // both static traders' portfolios are reused
+  ResourceExchange<Material> second(tc.get());
+  second.prev_history(&first.history());
+  second.AddAllRequests();
+  second.AddAllBids();
+  EXPECT_EQ(1, sreqr->req_ctr_);
+  EXPECT_EQ(2, reqr2->req_ctr_);
+  EXPECT_EQ(1, sbidr->bid_ctr_);
+  EXPECT_EQ(2, bidr2->bid_ctr_);
+  EXPECT_EQ(first.ex_ctx().requests, second.ex_ctx().requests);
+  EXPECT_EQ(first.ex_ctx().bids_by_request, second.ex_ctx().bids_by_request);
+
+  // a new request for the commodity invalidates the static bids
+  reqr2->port_.reset(new RequestPortfolio<Material>());
+  req = reqr2->port_->AddRequest(mat, reqr2, commod);
+  ResourceExchange<Material> third(tc.get());
+  third.nthreads(2);
+  third.prev_history(&second.history());
+  third.AddAllRequests();
+  third.AddAllBids();
+  EXPECT_EQ(1, sreqr->req_ctr_);
+  EXPECT_EQ(2, sbidr->bid_ctr_);
+  EXPECT_EQ(2, third.ex_ctx().requests.size());
+
+  for (int i = 0; i < 4; ++i) {
+    facs[i]->Decommission();
+  }
+  delete sreqr_proto;
+  delete sbidr_proto;
+  delete bidr_proto;
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+class SafeParent: public Requester {
+ public:
+  SafeParent(Context* ctx) : Requester(ctx), nadjust(0) {}
+
+  virtual cyclus::Agent* Clone() {
+    SafeParent* m = new SafeParent(context());
+    m->InitFrom(this);
+    return m;
+  }
+
+  set<RequestPortfolio<Material>::Ptr> GetMatlRequests() {
+    return set<RequestPortfolio<Material>::Ptr>();
+  }
+
+  virtual void AdjustMatlPrefs(PrefMap<Material>::type& prefs) {
+    cyclus::PrefView<Material> view(prefs);
+    for (int i = 0; i < view.size(); ++i) {
+      *view.prefs[i] *= 2;
+    }
+    ++nadjust;
+  }
+
+  virtual bool ThreadSafePrefs() { return true; }
+
+  std::atomic<int> nadjust;
+};
+
+TEST_F(ResourceExchangeTests, ThreadedPrefs) {
+  SafeParent* proto = new SafeParent(tc.get());
+  SafeRequester* safereqr = new SafeRequester(tc.get());
+  Bidder* bidr = new Bidder(tc.get(), commod);
+  Facility* parent = dynamic_cast<Facility*>(proto->Clone());
+  parent->Build(NULL);
+
+  // thread safe children, and one that isn't
+  std::vector<Requester*> reqrs;
+  std::vector<Request<Material>*> reqs;
+  std::vector<Facility*> facs;
+  for (int i = 0; i < 9; ++i) {
+    Facility* f = dynamic_cast<Facility*>(
+        i == 0 ? reqr->Clone() : safereqr->Clone());
+    f->Build(parent);
+    Requester* r = dynamic_cast<Requester*>(f);
+    r->port_.reset(new RequestPortfolio<Material>());
+    reqs.push_back(r->port_->AddRequest(mat, r, commod, pref));
+    reqrs.push_back(r);
+    facs.push_back(f);
+  }
+  Facility* b = dynamic_cast<Facility*>(bidr->Clone());
+  b->Build(NULL);
+  Bidder* bd = dynamic_cast<Bidder*>(b);
+  bd->port_.reset(new BidPortfolio<Material>());
+  std::vector<Bid<Material>*> bids;
+  for (int i = 0; i < reqs.size(); ++i) {
+    bids.push_back(bd->port_->AddBid(reqs[i], mat, bd));
+  }
+
+  exchng->nthreads(4);
+  exchng->AddAllRequests();
+  exchng->AddAllBids();
+  exchng->AdjustAll();
+
+  // each child squares its preference, then the parent doubles it
+  SafeParent* p = dynamic_cast<SafeParent*>(parent);
+  EXPECT_EQ(9, p->nadjust);
+  for (int i = 0; i < reqrs.size(); ++i) {
+    EXPECT_EQ(1, reqrs[i]->pref_ctr_);
+    EXPECT_DOUBLE_EQ(2 * pref * pref,
+                     exchng->ex_ctx().trader_prefs[reqrs[i]][reqs[i]][bids[i]]);
+  }
+
+  b->Decommission();
+  for (int i = 0; i < facs.size(); ++i) {
+    facs[i]->Decommission();
+  }
+  parent->Decommission();
+  delete proto;
+  delete safereqr;
+  delete bidr;
+}
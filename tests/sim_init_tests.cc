@@ -160,6 +160,9 @@ class SimInitTest : public ::testing::Test {
   int transid(cy::Context* ctx) { return ctx->trans_id_; }
 
   cy::SimInfo siminfo(cy::Context* ctx) { return ctx->si_; }
+  void incremental_snapshot(cy::Context* ctx) {
+    ctx->si_.incremental_snapshot = true;
+  }
   std::set<Agent*> agent_list(cy::Context* ctx) { return ctx->agent_list_; }
   std::map<int, cy::TimeListener*> tickers(cy::Timer* ti) { return ti->tickers_; }
 
@@ -440,3 +443,110 @@ TEST_F(SimInitTest, RestartSimInfo) {
   EXPECT_EQ("restart", info.parent_type);
   EXPECT_EQ(2, info.branch_time);
 }
+
+TEST_F(SimInitTest, IncrementalSnapshot) {
+  incremental_snapshot(ctx);
+  std::vector<cy::Cond> conds;
+  conds.push_back(cy::Cond("SimId", "==", rec.sim_id()));
+  int n = b->Query("AgentStateAgent", &conds).rows.size();
+
+  // no agent has an incremental snapshot yet
+  cy::SimInit::Snapshot(ctx);
+  rec.Flush();
+  EXPECT_EQ(n + 2, b->Query("AgentStateAgent", &conds).rows.size());
+
+  cy::SimInit::Snapshot(ctx);
+  rec.Flush();
+  EXPECT_EQ(n + 2, b->Query("AgentStateAgent", &conds).rows.size());
+
+  std::set<Agent*> agents = agent_list(ctx);
+  std::set<Agent*>::iterator it;
+  for (it = agents.begin(); it != agents.end(); ++it) {
+    if ((*it)->enter_time() != -1) {
+      dynamic_cast<Inver*>(*it)->val1 = 42;
+      break;
+    }
+  }
+  cy::SimInit::Snapshot(ctx);
+  rec.Flush();
+  EXPECT_EQ(n + 3, b->Query("AgentStateAgent", &conds).rows.size());
+}
+
+TEST_F(SimInitTest, RestartIncremental) {
+  incremental_snapshot(ctx);
+  cy::PyStart();
+  ti.RunSim();
+  rec.Flush();
+  cy::SimInit si;
+  si.Restart(b, rec.sim_id(), 2);
+  cy::PyStop();
+
+  std::set<Agent*> agents = agent_list(si.context());
+  std::set<Agent*>::iterator it;
+  int nloaded = 0;
+  for (it = agents.begin(); it != agents.end(); ++it) {
+    Inver* a = dynamic_cast<Inver*>(*it);
+    if (a->enter_time() == -1) {
+      continue;  // skip prototypes
+    }
+    ++nloaded;
+
+    // the agent never changed, so it was loaded from its first snapshot
+    std::vector<cy::Cond> conds;
+    conds.push_back(cy::Cond("SimId", "==", rec.sim_id()));
+    conds.push_back(cy::Cond("AgentId", "==", a->id()));
+    conds.push_back(cy::Cond("SimTime", "==", 2));
+    EXPECT_EQ(0, b->Query("AgentStateAgent", &conds).rows.size());
+    EXPECT_EQ(26, a->val1);
+    EXPECT_EQ(1, a->buf1.count());
+    EXPECT_EQ(2, a->buf2.count());
+  }
+  EXPECT_EQ(1, nloaded);
+}
+
+TEST(AgentStateCacheTest, PerAgentRows) {
+  cy::Recorder rec;
+  cy::SqliteBack b(dbpath);
+  rec.RegisterBackend(&b);
+  int rows[][3] = {{1, 0, 10}, {1, 2, 12}, {2, 0, 20}, {2, 0, 21}, {3, 1, 31}};
+  for (int i = 0; i < 5; ++i) {
+    rec.NewDatum("AgentStateFoo")
+        ->AddVal("AgentId", rows[i][0])
+        ->AddVal("SimTime", rows[i][1])
+        ->AddVal("x", rows[i][2])
+        ->Record();
+  }
+  rec.NewDatum("Other")->AddVal("AgentId", 1)->Record();
+  rec.Flush();
+
+  std::map<int, int> snap_times;
+  snap_times[1] = 2;
+  snap_times[2] = 0;
+  cy::AgentStateCache cache(&b, snap_times);
+  cy::PrefixInjector pi(&cache, "AgentState");
+
+  cache.agent(1);
+  cy::QueryResult qr = pi.Query("Foo", NULL);
+  ASSERT_EQ(1, qr.rows.size());
+  EXPECT_EQ(12, qr.GetVal<int>("x"));
+
+  cache.agent(2);
+  qr = pi.Query("Foo", NULL);
+  ASSERT_EQ(2, qr.rows.size());
+  EXPECT_EQ(21, qr.GetVal<int>("x", 1));
+
+  // agents without a snapshot at their time have no rows
+  cache.agent(3);
+  qr = pi.Query("Foo", NULL);
+  EXPECT_EQ(0, qr.rows.size());
+  EXPECT_EQ(4, qr.fields.size());
+
+  // queries with conditions are passed on with the agent's conditions
+  cache.agent(2);
+  std::vector<cy::Cond> conds;
+  conds.push_back(cy::Cond("x", ">", 20));
+  EXPECT_EQ(1, pi.Query("Foo", &conds).rows.size());
+
+  EXPECT_THROW(pi.Query("Missing", NULL), cy::Error);
+  EXPECT_THROW(cache.Query("Other", NULL), cy::Error);  // no SimTime column
+}
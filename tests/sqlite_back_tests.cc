@@ -576,3 +576,209 @@ TEST_F(SqliteBackTests, ListPairIntInt) {
   EXPECT_EQ(std::make_pair(4, 2), l.front());
   EXPECT_EQ(std::make_pair(5, 3), l.back());
 }
+
+TEST_F(SqliteBackTests, IndexesAndCachedQueries) {
+  for (int i = 0; i < 10; ++i) {
+    r.NewDatum("Agents")
+        ->AddVal("AgentId", i)
+        ->AddVal("Time", i % 3)
+        ->AddVal("Name", std::string("agent"))
+        ->Record();
+  }
+  r.Close();
+
+  std::vector<cyclus::Cond> conds;
+  conds.push_back(cyclus::Cond("Time", "==", 1));
+  conds.push_back(cyclus::Cond("AgentId", ">", 4));
+  EXPECT_EQ(1, b->Query("Agents", &conds).rows.size());
+  conds[0] = cyclus::Cond("Time", "==", 0);
+  conds[1] = cyclus::Cond("AgentId", ">", 0);
+  cyclus::QueryResult qr = b->Query("Agents", &conds);
+  ASSERT_EQ(3, qr.rows.size());
+  EXPECT_EQ(3, qr.GetVal<int>("AgentId", 0));
+  EXPECT_EQ(9, qr.GetVal<int>("AgentId", 2));
+
+  cyclus::SqlStatement::Ptr stmt = b->db().Prepare(
+      "SELECT name FROM sqlite_master WHERE type='index' "
+      "AND tbl_name='Agents' ORDER BY name;");
+  std::vector<std::string> idx;
+  while (stmt->Step()) {
+    idx.push_back(stmt->GetText(0, NULL));
+  }
+  ASSERT_EQ(3, idx.size());
+  EXPECT_EQ("Agents_AgentId_idx", idx[0]);
+  EXPECT_EQ("Agents_SimId_idx", idx[1]);
+  EXPECT_EQ("Agents_Time_idx", idx[2]);
+
+  EXPECT_THROW(b->Query("Missing", NULL), cyclus::ValueError);
+}
+
+TEST_F(SqliteBackTests, IndexFields) {
+  std::set<std::string> fields;
+  fields.insert("Name");
+  b->index_fields(fields);
+  r.NewDatum("Agents")
+      ->AddVal("AgentId", 1)
+      ->AddVal("Name", std::string("agent"))
+      ->Record();
+  r.Close();
+  b->Close();
+
+  cyclus::SqlStatement::Ptr stmt = b->db().Prepare(
+      "SELECT name FROM sqlite_master WHERE type='index';");
+  ASSERT_TRUE(stmt->Step());
+  EXPECT_EQ(std::string("Agents_Name_idx"), stmt->GetText(0, NULL));
+  EXPECT_FALSE(stmt->Step());
+}
+
+TEST_F(SqliteBackTests, QueryColumns) {
+  for (int i = 0; i < 4; ++i) {
+    r.NewDatum("Agents")
+        ->AddVal("AgentId", i)
+        ->AddVal("Mass", 1.5 * i)
+        ->AddVal("Alive", i % 2 == 0)
+        ->AddVal("Name", std::string(i < 2 ? "a" : "b"))
+        ->AddVal("Ids", std::vector<int>(i, 1))
+        ->Record();
+  }
+  r.Close();
+
+  std::vector<cyclus::Cond> conds;
+  conds.push_back(cyclus::Cond("AgentId", ">", 0));
+  cyclus::ColumnarResult cr = b->QueryColumns("Agents", &conds);
+  cyclus::QueryResult qr = b->Query("Agents", &conds);
+  ASSERT_EQ(3, cr.nrows);
+  ASSERT_EQ(qr.fields.size(), cr.columns.size());
+
+  cyclus::QueryColumn& simid = cr.column("SimId");
+  ASSERT_EQ(1, simid.uuids.size());
+  EXPECT_EQ(r.sim_id(), simid.uuids[0]);
+  EXPECT_EQ(std::vector<int>(3, 0), simid.codes);
+
+  std::vector<int> ids;
+  ids.push_back(1);
+  ids.push_back(2);
+  ids.push_back(3);
+  EXPECT_EQ(ids, cr.column("AgentId").ints);
+  EXPECT_DOUBLE_EQ(4.5, cr.column("Mass").doubles[2]);
+  EXPECT_EQ(1, cr.column("Alive").ints[1]);
+
+  cyclus::QueryColumn& name = cr.column("Name");
+  ASSERT_EQ(2, name.strs.size());
+  EXPECT_EQ("a", name.strs[name.codes[0]]);
+  EXPECT_EQ("b", name.strs[name.codes[2]]);
+  EXPECT_EQ(3, cr.column("Ids").vals[2].cast<std::vector<int> >().size());
+}
+
+TEST_F(SqliteBackTests, Cursor) {
+  for (int i = 0; i < 10; ++i) {
+    r.NewDatum("Agents")->AddVal("AgentId", i)->Record();
+  }
+  r.Close();
+
+  std::vector<cyclus::Cond> conds;
+  conds.push_back(cyclus::Cond("AgentId", ">=", 3));
+  cyclus::QueryCursor::Ptr c = b->Cursor("Agents", &conds);
+
+  // cached queries run while the cursor is open don't disturb it
+  EXPECT_EQ(7, b->Query("Agents", &conds).rows.size());
+
+  cyclus::QueryResult qr;
+  std::vector<int> ids;
+  while (c->Fetch(3, &qr)) {
+    EXPECT_GE(3, qr.rows.size());
+    EXPECT_EQ(2, qr.fields.size());
+    for (int i = 0; i < qr.rows.size(); ++i) {
+      ids.push_back(qr.GetVal<int>("AgentId", i));
+    }
+  }
+  ASSERT_EQ(7, ids.size());
+  EXPECT_EQ(3, ids[0]);
+  EXPECT_EQ(9, ids[6]);
+  EXPECT_FALSE(c->Fetch(3, &qr));
+
+  cyclus::PrefixInjector pi(b, "Ag");
+  cyclus::CondInjector ci(&pi, conds);
+  EXPECT_TRUE(ci.Cursor("ents", NULL)->Fetch(100, &qr));
+  EXPECT_EQ(7, qr.rows.size());
+}
+
+TEST_F(SqliteBackTests, Projection) {
+  for (int i = 0; i < 10; ++i) {
+    r.NewDatum("Agents")
+        ->AddVal("AgentId", i)
+        ->AddVal("Kind", std::string(i % 2 ? "odd" : "even"))
+        ->AddVal("Mass", 2.0 * i)
+        ->Record();
+  }
+  r.Close();
+
+  // conditions may use columns that aren't returned
+  std::vector<cyclus::Cond> conds;
+  conds.push_back(cyclus::Cond("AgentId", ">=", 6));
+  std::vector<std::string> cols;
+  cols.push_back("Mass");
+  cols.push_back("Kind");
+  cyclus::QueryResult qr = b->Query("Agents", &conds, &cols);
+  EXPECT_EQ(cols, qr.fields);
+  EXPECT_EQ(cyclus::DOUBLE, qr.types[0]);
+  ASSERT_EQ(4, qr.rows.size());
+  ASSERT_EQ(2, qr.rows[0].size());
+  EXPECT_DOUBLE_EQ(12, qr.GetVal<double>("Mass", 0));
+  EXPECT_EQ("odd", qr.GetVal<std::string>("Kind", 1));
+
+  cyclus::ColumnarResult cr = b->QueryColumns("Agents", &conds, &cols);
+  ASSERT_EQ(2, cr.columns.size());
+  EXPECT_DOUBLE_EQ(18, cr.column("Mass").doubles[3]);
+
+  cyclus::PrefixInjector pi(b, "Ag");
+  cyclus::CondInjector ci(&pi, conds);
+  ASSERT_TRUE(ci.Cursor("ents", NULL, &cols)->Fetch(100, &qr));
+  EXPECT_EQ(4, qr.rows.size());
+  EXPECT_EQ(cols, qr.fields);
+
+  cols.push_back("Foo");
+  EXPECT_THROW(b->Query("Agents", NULL, &cols), cyclus::KeyError);
+  cols.clear();
+  EXPECT_THROW(b->Query("Agents", NULL, &cols), cyclus::ValueError);
+  EXPECT_THROW(b->Cursor("Agents", NULL, &cols), cyclus::ValueError);
+}
+
+TEST_F(SqliteBackTests, Bulk) {
+  b->set_bulk(true);
+  EXPECT_TRUE(b->bulk());
+
+  std::map<std::string, double> m;
+  m["U235"] = 0.7;
+  for (int i = 0; i < 150; ++i) {
+    m["U238"] = i;
+    r.NewDatum("Big")
+        ->AddVal("Time", i)
+        ->AddVal("Comp", m)
+        ->Record();
+    if (i % 50 == 0) {
+      r.NewDatum("Small")->AddVal("Time", i)->Record();
+    }
+  }
+  r.Close();
+
+  b->set_bulk(false);
+  EXPECT_FALSE(b->bulk());
+  r.RegisterBackend(b);
+  m["U238"] = 150;
+  r.NewDatum("Big")
+      ->AddVal("Time", 150)
+      ->AddVal("Comp", m)
+      ->Record();
+  r.Close();
+
+  cyclus::QueryResult qr = b->Query("Big", NULL);
+  ASSERT_EQ(151, qr.rows.size());
+  for (int i = 0; i < qr.rows.size(); ++i) {
+    EXPECT_EQ(i, qr.GetVal<int>("Time", i));
+    m = qr.GetVal<std::map<std::string, double> >("Comp", i);
+    EXPECT_DOUBLE_EQ(0.7, m["U235"]);
+    EXPECT_DOUBLE_EQ(i, m["U238"]);
+  }
+  EXPECT_EQ(3, b->Query("Small", NULL).rows.size());
+}
@@ -1,3 +1,4 @@
+#include <cstdio>
 #include <string>
 #include <vector>
 
@@ -54,6 +55,23 @@ TEST_F(SqliteDbTests, Overwrite) {
   EXPECT_EQ(result.size(), 0);
 }
 
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+TEST_F(SqliteDbTests, Readonly) {
+  std::string fname = "readonly_test.sqlite";
+  remove(fname.c_str());
+  cyclus::SqliteDb rw(fname);
+  rw.Execute("create table t1 (data1 TEXT);");
+  EXPECT_FALSE(rw.readonly());
+  rw.close();
+
+  cyclus::SqliteDb ro(fname, true);
+  EXPECT_TRUE(ro.readonly());
+  EXPECT_THROW(ro.Execute("create index t1_idx on t1 (data1);"),
+               cyclus::IOError);
+  ro.close();
+  remove(fname.c_str());
+}
+
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 TEST_F(SqliteDbTests, CreateAndInsert) {
   using cyclus::SqliteDb;
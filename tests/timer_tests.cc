@@ -97,6 +97,38 @@ class SnapperDec : public cyclus::Facility {
   bool snap;
 };
 
+class Holder : public cyclus::Facility {
+ public:
+  Holder(cyclus::Context* ctx) : cyclus::Facility(ctx) {}
+  virtual ~Holder() {}
+
+  virtual cyclus::Agent* Clone() { return new Holder(context()); }
+  virtual void InitInv(cyclus::Inventories& inv) {}
+  virtual cyclus::Inventories SnapshotInv() {
+    cyclus::Inventories invs;
+    invs["inv"] = inv;
+    return invs;
+  }
+
+  virtual void Build(cyclus::Agent* parent) {
+    cyclus::Facility::Build(parent);
+    cyclus::CompMap v;
+    v[922350000] = 1;
+    v[922380000] = 2;
+    cyclus::Composition::Ptr c1 = cyclus::Composition::CreateFromMass(v);
+    v[922380000] = 3;
+    cyclus::Composition::Ptr c2 = cyclus::Composition::CreateFromMass(v);
+    inv.push_back(cyclus::Material::Create(this, 1, c1));
+    inv.push_back(cyclus::Material::Create(this, 2, c1));
+    inv.push_back(cyclus::Material::Create(this, 3, c2));
+  }
+
+  void Tick() {}
+  void Tock() {}
+  void Decision() {}
+  std::vector<cyclus::Resource::Ptr> inv;
+};
+
 TEST(TimerTests, BareSim) {
   cyclus::PyStart();
   cyclus::Recorder rec;
@@ -134,6 +166,44 @@ TEST(TimerTests, EarlyTermination) {
   cyclus::PyStop();
 }
 
+TEST(TimerTests, ExplicitInventory) {
+  cyclus::PyStart();
+  cyclus::Recorder rec;
+  cyclus::Timer ti;
+  cyclus::Context ctx(&ti, &rec);
+  cyclus::SqliteBack b(path);
+  rec.RegisterBackend(&b);
+
+  cyclus::SimInfo si(1);
+  si.explicit_inventory = true;
+  si.explicit_inventory_compact = true;
+  ti.Initialize(&ctx, si);
+
+  Holder* h = new Holder(&ctx);
+  h->Build(NULL);
+
+  ti.RunSim();
+  rec.Close();
+
+  cyclus::QueryResult qr = b.Query("ExplicitInventory", NULL);
+  ASSERT_EQ(2, qr.rows.size());
+  std::map<int, double> qtys;
+  for (int i = 0; i < qr.rows.size(); ++i) {
+    EXPECT_EQ("inv", qr.GetVal<std::string>("InventoryName", i));
+    qtys[qr.GetVal<int>("NucId", i)] = qr.GetVal<double>("Quantity", i);
+  }
+  EXPECT_DOUBLE_EQ(1.75, qtys[922350000]);
+  EXPECT_DOUBLE_EQ(4.25, qtys[922380000]);
+
+  qr = b.Query("ExplicitInventoryCompact", NULL);
+  ASSERT_EQ(1, qr.rows.size());
+  EXPECT_DOUBLE_EQ(6, qr.GetVal<double>("Quantity"));
+  cyclus::CompMap c = qr.GetVal<cyclus::CompMap>("Composition");
+  EXPECT_DOUBLE_EQ(1.75 / 6, c[922350000]);
+  EXPECT_DOUBLE_EQ(4.25 / 6, c[922380000]);
+  cyclus::PyStop();
+}
+
 TEST(TimerTests, DefaultSnapshotTick) {
   cyclus::PyStart();
   cyclus::Recorder rec;
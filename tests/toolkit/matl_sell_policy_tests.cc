@@ -98,7 +98,8 @@ TEST_F(MatlSellPolicyTests, Bids) {
   p.Init(NULL, &buff, "", qty, true, qty / 2).Set(commod);
   obs = p.GetMatlBids(reqs);
   ASSERT_EQ(obs.size(), 1);
-  ASSERT_EQ((*obs.begin())->bids().size(), 2);
+  ASSERT_EQ((*obs.begin())->bids().size(), 1);
+  ASSERT_EQ((*(*obs.begin())->bids().begin())->multiplicity(), 2);
   ASSERT_FLOAT_EQ((*(*obs.begin())->bids().begin())->offer()->quantity(),
                   mat->quantity() / 2);
   ASSERT_EQ((*(*obs.begin())->bids().begin())->offer()->comp(), comp1);